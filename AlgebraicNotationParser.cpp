@@ -1,6 +1,7 @@
 #include "AlgebraicNotationParser.h"
 #include "ChessEngine.h"
 #include "Move.h"
+#include "MovePicker.h"
 #include <algorithm>
 #include <cctype>
 #include <stdexcept>
@@ -19,10 +20,10 @@ std::string AlgebraicNotationParser::toAlgebraicNotation(const Move& move) {
         notation = "O-O-O";
     } else {
         auto piece = move.getPieceMoved();
-        std::string pieceType = piece->getType();
+        PieceType pieceType = piece->getPieceType();
         
         // Add piece letter (except for pawns)
-        if (pieceType != "Pawn") {
+        if (pieceType != PAWN) {
             notation += piece->getPieceLetter();
         }
         
@@ -36,7 +37,7 @@ std::string AlgebraicNotationParser::toAlgebraicNotation(const Move& move) {
         // Add capture symbol
         if (move.getPieceCaptured() != nullptr || move.getIsEnpassantMove()) {
             // For pawn captures, add the file letter
-            if (pieceType == "Pawn" && disambiguation.empty()) {
+            if (pieceType == PAWN && disambiguation.empty()) {
                 notation += move.getStartSquare()->getAlgebraicNotation()[0];
             }
             notation += "x";
@@ -67,41 +68,42 @@ Move AlgebraicNotationParser::parseMove(const std::string& san) {
     }
     
     // Handle castling
-    if (cleanSan == "O-O" || cleanSan == "0-0") {
-        // King-side castling
-        for (const auto& move : engine->getAllLegalMoves()) {
-            if (move.getIsKingSideCastle()) {
-                return move;
-            }
-        }
-        throw std::runtime_error("Invalid move: King-side castling not available");
-    }
+    bool kingSide = (cleanSan == "O-O" || cleanSan == "0-0");
+    bool queenSide = (cleanSan == "O-O-O" || cleanSan == "0-0-0");
     
-    if (cleanSan == "O-O-O" || cleanSan == "0-0-0") {
-        // Queen-side castling
-        for (const auto& move : engine->getAllLegalMoves()) {
-            if (move.getIsQueenSideCastle()) {
-                return move;
+    // Legal moves come one at a time, so the search stops at the first match
+    MovePicker picker(*engine);
+    for (PackedMove packed = picker.next(); !packed.isNull(); packed = picker.next()) {
+        if (kingSide || queenSide) {
+            int wanted = kingSide ? PackedMove::KING_CASTLE : PackedMove::QUEEN_CASTLE;
+            if (packed.getFlags() == wanted) {
+                return engine->toMove(packed);
             }
+            continue;
         }
-        throw std::runtime_error("Invalid move: Queen-side castling not available");
-    }
-    
-    // Find matching move from legal moves
-    std::vector<Move> legalMoves = engine->getAllLegalMoves();
-    
-    for (const auto& move : legalMoves) {
+        
+        // Only build the full move once the destination square appears in the SAN
+        if (cleanSan.find(packed.toString().substr(2, 2)) == std::string::npos) {
+            continue;
+        }
+        Move move = engine->toMove(packed);
         if (moveMatchesSAN(move, cleanSan)) {
             return move;
         }
     }
     
+    if (kingSide) {
+        throw std::runtime_error("Invalid move: King-side castling not available");
+    }
+    if (queenSide) {
+        throw std::runtime_error("Invalid move: Queen-side castling not available");
+    }
     throw std::runtime_error("Invalid move: No legal move matches notation '" + san + "'");
 }
 
 bool AlgebraicNotationParser::moveMatchesSAN(const Move& move, const std::string& san) const {
     auto piece = move.getPieceMoved();
-    std::string pieceType = piece->getType();
+    PieceType pieceType = piece->getPieceType();
     std::string destination = move.getEndSquare()->getAlgebraicNotation();
     
     // Check if destination matches (SAN must contain the destination square)
@@ -119,7 +121,7 @@ bool AlgebraicNotationParser::moveMatchesSAN(const Move& move, const std::string
                                 san[0] == 'B' || san[0] == 'N');
     
     // Handle pawn moves - no piece letter at start (unless capturing)
-    if (pieceType == "Pawn") {
+    if (pieceType == PAWN) {
         // If SAN starts with a piece letter, this can't be a pawn move
         if (sanStartsWithPiece) {
             return false;
@@ -134,10 +136,8 @@ bool AlgebraicNotationParser::moveMatchesSAN(const Move& move, const std::string
                     if (san.find('=') != std::string::npos) {
                         // Extract the promotion piece letter from the notation
                         char promoPieceLetter = san[san.find('=') + 1];
-                        // Match based on the notation letter (Q, R, B, N)
-                        // Since promotion pieces are now null, we just verify it's a valid promotion
-                        return (promoPieceLetter == 'Q' || promoPieceLetter == 'R' || 
-                                promoPieceLetter == 'B' || promoPieceLetter == 'N');
+                        // Each promotion piece is a separate legal move
+                        return promoPieceLetter == move.getPawnPromotionPiece()->getPieceLetter()[0];
                     }
                     return false;
                 }
@@ -152,9 +152,8 @@ bool AlgebraicNotationParser::moveMatchesSAN(const Move& move, const std::string
                     if (san.find('=') != std::string::npos) {
                         // Extract the promotion piece letter from the notation
                         char promoPieceLetter = san[san.find('=') + 1];
-                        // Match based on the notation letter (Q, R, B, N)
-                        return (promoPieceLetter == 'Q' || promoPieceLetter == 'R' || 
-                                promoPieceLetter == 'B' || promoPieceLetter == 'N');
+                        // Each promotion piece is a separate legal move
+                        return promoPieceLetter == move.getPawnPromotionPiece()->getPieceLetter()[0];
                     }
                     return false;
                 }
@@ -219,10 +218,10 @@ bool AlgebraicNotationParser::moveMatchesSAN(const Move& move, const std::string
 
 std::string AlgebraicNotationParser::getDisambiguation(const Move& move, const std::vector<Move>& legalMoves) const {
     auto piece = move.getPieceMoved();
-    std::string pieceType = piece->getType();
+    PieceType pieceType = piece->getPieceType();
     
     // Pawns don't need disambiguation (except for captures, handled separately)
-    if (pieceType == "Pawn") {
+    if (pieceType == PAWN) {
         return "";
     }
     
@@ -234,14 +233,16 @@ std::string AlgebraicNotationParser::getDisambiguation(const Move& move, const s
     bool needsRankDisambig = false;
     
     for (const auto& otherMove : legalMoves) {
-        if (&otherMove == &move) continue;
-        
         auto otherPiece = otherMove.getPieceMoved();
         auto otherStart = otherMove.getStartSquare();
+        
+        // Skip the move itself (legal moves are copies, so compare squares)
+        if (otherStart->getRow() == startSquare->getRow() &&
+            otherStart->getCol() == startSquare->getCol()) continue;
         auto otherEnd = otherMove.getEndSquare();
         
         // Check if same piece type and same destination
-        if (otherPiece->getType() == pieceType &&
+        if (otherPiece->getPieceType() == pieceType &&
             otherEnd->getRow() == endSquare->getRow() &&
             otherEnd->getCol() == endSquare->getCol()) {
             
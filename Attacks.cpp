@@ -0,0 +1,196 @@
+#include "Attacks.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_PEXT 1
+#endif
+
+// Per-square slider table entry. The relevant occupancy is the mask of
+// squares that can block the piece (board edges excluded), and each subset
+// of it maps to its own slot in the shared attack table.
+struct SliderTable
+{
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard* attacks;
+    int shift;
+};
+
+static SliderTable rookTables[64];
+static SliderTable bishopTables[64];
+static Bitboard rookAttackTable[0x19000];    // 102400 entries, sum of 2^bits(mask)
+static Bitboard bishopAttackTable[0x1480];   // 5248 entries
+static bool usePext = false;
+
+Bitboard betweenTable[64][64];
+Bitboard lineTable[64][64];
+
+#ifdef HAVE_X86_PEXT
+__attribute__((target("bmi2")))
+static inline unsigned pextIndex(Bitboard occupied, Bitboard mask)
+{
+    return static_cast<unsigned>(_pext_u64(occupied, mask));
+}
+#endif
+
+static inline unsigned tableIndex(const SliderTable& table, Bitboard occupied)
+{
+#ifdef HAVE_X86_PEXT
+    if(usePext)
+    {
+        return pextIndex(occupied, table.mask);
+    }
+#endif
+    return static_cast<unsigned>(((occupied & table.mask) * table.magic) >> table.shift);
+}
+
+Bitboard rookAttacks(int square, Bitboard occupied)
+{
+    const SliderTable& table = rookTables[square];
+    return table.attacks[tableIndex(table, occupied)];
+}
+
+Bitboard bishopAttacks(int square, Bitboard occupied)
+{
+    const SliderTable& table = bishopTables[square];
+    return table.attacks[tableIndex(table, occupied)];
+}
+
+bool usingPextAttacks()
+{
+    return usePext;
+}
+
+// Walk each direction one square at a time; only used to fill the tables
+static Bitboard slowSliderAttacks(int square, Bitboard occupied, const int directions[4][2])
+{
+    Bitboard attacks = 0;
+    for(int d = 0; d < 4; d++)
+    {
+        int row = squareRow(square) + directions[d][0];
+        int col = squareCol(square) + directions[d][1];
+        while(row >= 0 && row < 8 && col >= 0 && col < 8)
+        {
+            attacks |= squareBitboard(row, col);
+            if(occupied & squareBitboard(row, col))
+            {
+                break;
+            }
+            row += directions[d][0];
+            col += directions[d][1];
+        }
+    }
+    return attacks;
+}
+
+// Squares that can block a slider: its empty-board attacks minus the board
+// edges it is not standing on
+static Bitboard relevantMask(int square, const int directions[4][2])
+{
+    const Bitboard rank1 = 0xFF00000000000000ULL, rank8 = 0xFFULL;
+    const Bitboard fileA = 0x0101010101010101ULL, fileH = 0x8080808080808080ULL;
+    Bitboard edges = ((rank1 | rank8) & ~(rank8 << (8 * squareRow(square)))) |
+                     ((fileA | fileH) & ~(fileA << squareCol(square)));
+    return slowSliderAttacks(square, 0, directions) & ~edges;
+}
+
+// Magic multipliers for the a8 = 0 square layout. Each maps every subset of
+// the square's mask to a distinct slot (or one with identical attacks).
+static const Bitboard rookMagics[64] = {
+    0x0480046281400010ULL, 0x80C0200010004000ULL, 0x8780200008300180ULL, 0x8880060800100080ULL,
+    0x2100030010080084ULL, 0x0100040001000802ULL, 0x0200040800810200ULL, 0x0580008002407100ULL,
+    0x1000800080400020ULL, 0x0080401000402001ULL, 0x800C802002100880ULL, 0x800A002200884010ULL,
+    0x2046002008108600ULL, 0x0222009002000804ULL, 0x100B000421001200ULL, 0x0240800100004080ULL,
+    0x4540008020408006ULL, 0x8010054020084002ULL, 0x7D10010100200040ULL, 0x1408008010000882ULL,
+    0x4408010005000810ULL, 0x001E008004000280ULL, 0x0230040001080210ULL, 0x0000020004004081ULL,
+    0x0100400080208001ULL, 0x1000842300400100ULL, 0x1060100080200082ULL, 0x3219004B00100020ULL,
+    0x9010080080800400ULL, 0x8440020080800400ULL, 0x6008010080800200ULL, 0x4123008200010044ULL,
+    0x0280002001400240ULL, 0x0220100040400020ULL, 0x0060801003802008ULL, 0x0008100080800800ULL,
+    0x0105000801001004ULL, 0x100B000803000400ULL, 0x0000024814001021ULL, 0x00408000C2802100ULL,
+    0x4C40004020808002ULL, 0x4410500420024000ULL, 0x00C0100020008080ULL, 0x0000100008008080ULL,
+    0x8002000804220011ULL, 0x0802000804010100ULL, 0x0243100201040008ULL, 0x0000009100420014ULL,
+    0x1000400280022480ULL, 0x0020200040100040ULL, 0x00A000100800C140ULL, 0x0410001408008080ULL,
+    0x0000080004008080ULL, 0x0100020004008080ULL, 0x0303000200040300ULL, 0x1480006104008200ULL,
+    0x00008002204A1101ULL, 0x1040090010224081ULL, 0x4300C0200011000DULL, 0x8002041001002009ULL,
+    0x2005000800020411ULL, 0x110A008408100102ULL, 0x0006000108008402ULL, 0x0200002900884402ULL
+};
+
+static const Bitboard bishopMagics[64] = {
+    0x48081010008A2A80ULL, 0x000948110C0B2081ULL, 0x0944140400500000ULL, 0x4984104A00000101ULL,
+    0x4004030818283008ULL, 0x0206012462000121ULL, 0x1A02013008040001ULL, 0x0001008044200440ULL,
+    0x0000312208080880ULL, 0x0220021002009900ULL, 0x8080880801082000ULL, 0x000C11040080102AULL,
+    0x1402440421000210ULL, 0x0010120802080A81ULL, 0x0080084202104028ULL, 0x1100002082082082ULL,
+    0x0008403429080820ULL, 0x8104868204040412ULL, 0x6424084043060030ULL, 0x1108000420401000ULL,
+    0x9004101202020240ULL, 0x0032400608200412ULL, 0x0001009610822080ULL, 0x0008403429080820ULL,
+    0x0008068340104200ULL, 0x0010102858090121ULL, 0x81004C0018080313ULL, 0x4048080004820002ULL,
+    0x000900401C004049ULL, 0x0009420121C1101CULL, 0x4828504005040211ULL, 0x4828504005040211ULL,
+    0x0041041381202000ULL, 0x01008C1005601680ULL, 0x01D010900002040AULL, 0x4040020080080080ULL,
+    0x4801080200802200ULL, 0x4801080200802200ULL, 0x0010046108108080ULL, 0x90409090810A0220ULL,
+    0x8004020242201020ULL, 0x8004020242201020ULL, 0x0202010028020480ULL, 0x0000041144000801ULL,
+    0x00002000A4021080ULL, 0x0504090045040200ULL, 0x8182041102094400ULL, 0x0550008100480101ULL,
+    0xC002080404040400ULL, 0x0382004108292000ULL, 0x12000100A8040020ULL, 0xA005020442088020ULL,
+    0x2000001102020300ULL, 0x000021E0420C8808ULL, 0x3060200484888400ULL, 0x01280101021A0802ULL,
+    0x1030820110010500ULL, 0x0080012608025800ULL, 0x0002810084008800ULL, 0x800080000C208800ULL,
+    0xA408002140028204ULL, 0x0010006020322084ULL, 0x0210401044110050ULL, 0x40106000A1160020ULL
+};
+
+static void initSliderTables(SliderTable tables[64], Bitboard* attackTable,
+                             const Bitboard magics[64], const int directions[4][2])
+{
+    Bitboard* next = attackTable;
+    for(int square = 0; square < 64; square++)
+    {
+        SliderTable& table = tables[square];
+        table.mask = relevantMask(square, directions);
+        table.magic = magics[square];
+        table.shift = 64 - popCount(table.mask);
+        table.attacks = next;
+
+        // Enumerate every subset of the mask (Carry-Rippler)
+        Bitboard subset = 0;
+        do
+        {
+            table.attacks[tableIndex(table, subset)] = slowSliderAttacks(square, subset, directions);
+            next++;
+            subset = (subset - table.mask) & table.mask;
+        } while(subset);
+    }
+}
+
+static void initLineTables()
+{
+    for(int from = 0; from < 64; from++)
+    {
+        for(int to = 0; to < 64; to++)
+        {
+            Bitboard ends = squareBitboard(from) | squareBitboard(to);
+            if(from != to && (rookAttacks(from, 0) & squareBitboard(to)))
+            {
+                betweenTable[from][to] = rookAttacks(from, squareBitboard(to)) & rookAttacks(to, squareBitboard(from));
+                lineTable[from][to] = (rookAttacks(from, 0) & rookAttacks(to, 0)) | ends;
+            }
+            else if(from != to && (bishopAttacks(from, 0) & squareBitboard(to)))
+            {
+                betweenTable[from][to] = bishopAttacks(from, squareBitboard(to)) & bishopAttacks(to, squareBitboard(from));
+                lineTable[from][to] = (bishopAttacks(from, 0) & bishopAttacks(to, 0)) | ends;
+            }
+        }
+    }
+}
+
+// Builds the tables before main runs
+static struct AttackTablesInit
+{
+    AttackTablesInit()
+    {
+#ifdef HAVE_X86_PEXT
+        __builtin_cpu_init();
+        usePext = __builtin_cpu_supports("bmi2");
+#endif
+        const int rookDirections[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+        const int bishopDirections[4][2] = {{1, 1}, {-1, 1}, {1, -1}, {-1, -1}};
+        initSliderTables(rookTables, rookAttackTable, rookMagics, rookDirections);
+        initSliderTables(bishopTables, bishopAttackTable, bishopMagics, bishopDirections);
+        initLineTables();
+    }
+} attackTablesInit;
@@ -0,0 +1,88 @@
+#ifndef ATTACKS_H
+#define ATTACKS_H
+
+#include "Bitboard.h"
+
+// Squares a rook or bishop on the given square attacks, stopping at (and
+// including) the first occupied square in each direction. Both are a single
+// lookup into tables built at startup, indexed with PEXT when the CPU has
+// BMI2 and with magic multiplication otherwise.
+Bitboard rookAttacks(int square, Bitboard occupied);
+Bitboard bishopAttacks(int square, Bitboard occupied);
+
+inline Bitboard queenAttacks(int square, Bitboard occupied)
+{
+    return rookAttacks(square, occupied) | bishopAttacks(square, occupied);
+}
+
+// Whether the slider tables are indexed with the BMI2 PEXT instruction
+bool usingPextAttacks();
+
+// Squares strictly between two squares on a shared rank, file or diagonal,
+// and the whole line through both; empty when they are not aligned
+extern Bitboard betweenTable[64][64];
+extern Bitboard lineTable[64][64];
+
+inline Bitboard squaresBetween(int from, int to)
+{
+    return betweenTable[from][to];
+}
+
+inline Bitboard lineThrough(int from, int to)
+{
+    return lineTable[from][to];
+}
+
+// Per-square attack masks for pieces with fixed jumps, built at compile time
+struct LeaperTable
+{
+    Bitboard squares[64];
+};
+
+template<int N>
+constexpr LeaperTable makeLeaperTable(const int (&offsets)[N][2])
+{
+    LeaperTable table = {};
+    for(int square = 0; square < 64; square++)
+    {
+        for(int i = 0; i < N; i++)
+        {
+            int row = squareRow(square) + offsets[i][0];
+            int col = squareCol(square) + offsets[i][1];
+            if(row >= 0 && row < 8 && col >= 0 && col < 8)
+            {
+                table.squares[square] |= 1ULL << makeSquareIndex(row, col);
+            }
+        }
+    }
+    return table;
+}
+
+constexpr int knightOffsets[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}};
+constexpr int kingOffsets[8][2] = {{0, 1}, {0, -1}, {1, 0}, {-1, 0}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+// White pawns capture towards row 0, black pawns towards row 7
+constexpr int whitePawnOffsets[2][2] = {{-1, -1}, {-1, 1}};
+constexpr int blackPawnOffsets[2][2] = {{1, -1}, {1, 1}};
+
+inline constexpr LeaperTable knightAttackTable = makeLeaperTable(knightOffsets);
+inline constexpr LeaperTable kingAttackTable = makeLeaperTable(kingOffsets);
+inline constexpr LeaperTable pawnAttackTables[2] = {makeLeaperTable(whitePawnOffsets),
+                                                    makeLeaperTable(blackPawnOffsets)};
+
+inline Bitboard knightAttacks(int square)
+{
+    return knightAttackTable.squares[square];
+}
+
+inline Bitboard kingAttacks(int square)
+{
+    return kingAttackTable.squares[square];
+}
+
+// Squares a pawn of the given color on this square captures on
+inline Bitboard pawnAttacks(Color color, int square)
+{
+    return pawnAttackTables[color].squares[square];
+}
+
+#endif // ATTACKS_H
@@ -0,0 +1,41 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "Types.h"
+#include <cstdint>
+
+// One bit per square, bit index = makeSquareIndex(row, col)
+typedef uint64_t Bitboard;
+
+const Bitboard ALL_SQUARES = ~0ULL;
+
+inline Bitboard squareBitboard(int square)
+{
+    return 1ULL << square;
+}
+
+inline Bitboard squareBitboard(int row, int col)
+{
+    return 1ULL << makeSquareIndex(row, col);
+}
+
+inline int popCount(Bitboard bitboard)
+{
+    return __builtin_popcountll(bitboard);
+}
+
+// Index of the lowest set bit; the bitboard must not be empty
+inline int lowestSquare(Bitboard bitboard)
+{
+    return __builtin_ctzll(bitboard);
+}
+
+// Remove and return the lowest set bit; the bitboard must not be empty
+inline int popLowestSquare(Bitboard& bitboard)
+{
+    int square = __builtin_ctzll(bitboard);
+    bitboard &= bitboard - 1;
+    return square;
+}
+
+#endif // BITBOARD_H
@@ -1,12 +1,92 @@
 #include "Board.h"
+#include <cstring>
 #include <iostream>
 using namespace std;
+
+// Piece code of a Piece object, used when a piece enters the board
+int Board::pieceCodeOf(const Piece& piece)
+{
+    return makePieceCode(piece.getColor(), piece.getPieceType());
+}
+
+// Whether a piece with this code on that square counts as moved. Kings and
+// rooks keep their flag exactly as long as a castling right depends on them,
+// other pieces as long as they stand on their starting square.
+static bool hasMovedFrom(int code, int square, int castlingRights)
+{
+    int row = squareRow(square);
+    int col = squareCol(square);
+    bool white = pieceCodeColor(code) == WHITE;
+    int kingside = white ? WHITE_KINGSIDE : BLACK_KINGSIDE;
+    int queenside = white ? WHITE_QUEENSIDE : BLACK_QUEENSIDE;
+    if(row != (white ? 7 : 0))
+    {
+        return pieceCodeType(code) != PAWN || row != (white ? 6 : 1);
+    }
+    switch(pieceCodeType(code))
+    {
+        case PAWN:
+            return true;
+        case KNIGHT:
+            return col != 1 && col != 6;
+        case BISHOP:
+            return col != 2 && col != 5;
+        case ROOK:
+            return !((col == 7 && (castlingRights & kingside)) || (col == 0 && (castlingRights & queenside)));
+        case QUEEN:
+            return col != 3;
+        default:
+            return col != 4 || !(castlingRights & (kingside | queenside));
+    }
+}
+
 Board::Board()
 {
     this->initEmptyBoard();
     this->setStartingPosition();
 }
 
+// Copies the position core; the copy gets its own Square view so the two
+// boards never share mutable squares or pieces
+Board::Board(const Board& other)
+{
+    this->initEmptyBoard();
+    *this = other;
+}
+
+Board& Board::operator=(const Board& other)
+{
+    if(this == &other)
+    {
+        return *this;
+    }
+    memcpy(this->pieceCodes, other.pieceCodes, sizeof(this->pieceCodes));
+    memcpy(this->pieceBitboards, other.pieceBitboards, sizeof(this->pieceBitboards));
+    memcpy(this->occupancy, other.occupancy, sizeof(this->occupancy));
+    // The other board's view may be stale, so the copy's is built from the
+    // core; the engine resyncs it with its own castling rights
+    this->syncSquares();
+    return *this;
+}
+
+void Board::savePieces(Position& position) const
+{
+    memcpy(position.pieces, this->pieceBitboards, sizeof(this->pieceBitboards));
+    memcpy(position.board, this->pieceCodes, sizeof(this->pieceCodes));
+}
+
+void Board::loadPieces(const Position& position)
+{
+    memcpy(this->pieceBitboards, position.pieces, sizeof(this->pieceBitboards));
+    memcpy(this->pieceCodes, position.board, sizeof(this->pieceCodes));
+    this->occupancy[WHITE] = 0;
+    this->occupancy[BLACK] = 0;
+    for(int code = 0; code < 12; code++)
+    {
+        this->occupancy[pieceCodeColor(code)] |= this->pieceBitboards[code];
+    }
+}
+
 void Board::initEmptyBoard()
 {
     for(int row = 0; row < 8; row++) 
@@ -14,45 +94,177 @@ void Board::initEmptyBoard()
         for(int col = 0; col < 8; col++) 
         {
             this->squares[row][col] = make_shared<Square>(row, col);
+            this->pieceCodes[makeSquareIndex(row, col)] = NO_PIECE;
+            this->viewCodes[makeSquareIndex(row, col)] = NO_PIECE;
         }
     }
+    for(int code = 0; code < 12; code++)
+    {
+        this->pieceBitboards[code] = 0;
+    }
+    this->occupancy[WHITE] = 0;
+    this->occupancy[BLACK] = 0;
 }
 
 void Board::setStartingPosition()
 {
     for(int col = 0; col < 8; col++) 
     {
-        squares[6][col]->setPiece(make_shared<Pawn>("white"));
-        squares[1][col]->setPiece(make_shared<Pawn>("black"));
+        placePiece(6, col, make_shared<Pawn>(WHITE));
+        placePiece(1, col, make_shared<Pawn>(BLACK));
 
         if(col == 0 || col == 7) 
         {
-            squares[7][col]->setPiece(make_shared<Rook>("white"));
-            squares[0][col]->setPiece(make_shared<Rook>("black"));
+            placePiece(7, col, make_shared<Rook>(WHITE));
+            placePiece(0, col, make_shared<Rook>(BLACK));
         }
         else if(col == 1 || col == 6) 
         {
-            squares[7][col]->setPiece(make_shared<Knight>("white"));
-            squares[0][col]->setPiece(make_shared<Knight>("black"));
+            placePiece(7, col, make_shared<Knight>(WHITE));
+            placePiece(0, col, make_shared<Knight>(BLACK));
         }
         else if(col == 2 || col == 5) 
         {
-            squares[7][col]->setPiece(make_shared<Bishop>("white"));
-            squares[0][col]->setPiece(make_shared<Bishop>("black"));
+            placePiece(7, col, make_shared<Bishop>(WHITE));
+            placePiece(0, col, make_shared<Bishop>(BLACK));
         }
         else if(col == 3) 
         {
-            squares[7][col]->setPiece(make_shared<Queen>("white"));
-            squares[0][col]->setPiece(make_shared<Queen>("black"));
+            placePiece(7, col, make_shared<Queen>(WHITE));
+            placePiece(0, col, make_shared<Queen>(BLACK));
         }
         else if(col == 4) 
         {
-            squares[7][col]->setPiece(make_shared<King>("white"));
-            squares[0][col]->setPiece(make_shared<King>("black"));
+            placePiece(7, col, make_shared<King>(WHITE));
+            placePiece(0, col, make_shared<King>(BLACK));
         }
     }
 }
 
+void Board::placePiece(int row, int col, shared_ptr<Piece> piece)
+{
+    int square = makeSquareIndex(row, col);
+    if(this->pieceCodes[square] != NO_PIECE)
+    {
+        this->removePiece(square);
+    }
+    int code = pieceCodeOf(*piece);
+    this->addPiece(square, code);
+    this->squares[row][col]->setPiece(piece);
+    this->viewCodes[square] = code;
+}
+
+void Board::addPiece(int square, int code)
+{
+    this->pieceCodes[square] = code;
+    this->pieceBitboards[code] |= squareBitboard(square);
+    this->occupancy[pieceCodeColor(code)] |= squareBitboard(square);
+}
+
+void Board::removePiece(int square)
+{
+    int code = this->pieceCodes[square];
+    this->pieceBitboards[code] &= ~squareBitboard(square);
+    this->occupancy[pieceCodeColor(code)] &= ~squareBitboard(square);
+    this->pieceCodes[square] = NO_PIECE;
+}
+
+// Moves a piece to an empty square; captured pieces must be removed first
+void Board::movePiece(int from, int to)
+{
+    int code = this->pieceCodes[from];
+    Bitboard fromTo = squareBitboard(from) | squareBitboard(to);
+    this->pieceBitboards[code] ^= fromTo;
+    this->occupancy[pieceCodeColor(code)] ^= fromTo;
+    this->pieceCodes[to] = code;
+    this->pieceCodes[from] = NO_PIECE;
+}
+
+void Board::syncSquares(int castlingRights)
+{
+    for(int square = 0; square < 64; square++)
+    {
+        int code = this->pieceCodes[square];
+        shared_ptr<Square> view = this->squares[squareRow(square)][squareCol(square)];
+        if(this->viewCodes[square] == code)
+        {
+            // Castling rights can go while the king or rook stays put
+            PieceType type = code == NO_PIECE ? PAWN : pieceCodeType(code);
+            if(type == KING || type == ROOK)
+            {
+                view->getPiece()->setMoved(hasMovedFrom(code, square, castlingRights));
+            }
+            continue;
+        }
+        if(code == NO_PIECE)
+        {
+            view->removePiece();
+        }
+        else
+        {
+            shared_ptr<Piece> piece = createPiece(code);
+            piece->setMoved(hasMovedFrom(code, square, castlingRights));
+            view->setPiece(piece);
+        }
+        this->viewCodes[square] = code;
+    }
+}
+
+shared_ptr<Piece> Board::createPiece(int code)
+{
+    Color color = pieceCodeColor(code);
+    switch(pieceCodeType(code))
+    {
+        case PAWN:
+            return make_shared<Pawn>(color);
+        case KNIGHT:
+            return make_shared<Knight>(color);
+        case BISHOP:
+            return make_shared<Bishop>(color);
+        case ROOK:
+            return make_shared<Rook>(color);
+        case QUEEN:
+            return make_shared<Queen>(color);
+        default:
+            return make_shared<King>(color);
+    }
+}
+
+Bitboard Board::getPieces(Color color, PieceType type) const
+{
+    return this->pieceBitboards[makePieceCode(color, type)];
+}
+
+Bitboard Board::getOccupancy(Color color) const
+{
+    return this->occupancy[color];
+}
+
+Bitboard Board::getOccupancy() const
+{
+    return this->occupancy[WHITE] | this->occupancy[BLACK];
+}
+
+int Board::getPieceCode(int square) const
+{
+    return this->pieceCodes[square];
+}
+
+int Board::getPieceCode(int row, int col) const
+{
+    return this->pieceCodes[makeSquareIndex(row, col)];
+}
+
+bool Board::isOccupied(int square) const
+{
+    return this->pieceCodes[square] != NO_PIECE;
+}
+
+bool Board::isOccupied(int row, int col) const
+{
+    return this->pieceCodes[makeSquareIndex(row, col)] != NO_PIECE;
+}
+
 shared_ptr<Square> Board::getSquare(int row, int col) 
 {
     if(row < 0 || row > 7 || col < 0 || col > 7) 
@@ -96,7 +308,7 @@ void Board::printBoard() const
             if(square->hasPiece()) 
             {
                 auto piece = square->getPiece();
-                string color = (piece->getColor() == "white") ? whitePieceFg : blackPieceFg;
+                string color = (piece->getColor() == WHITE) ? whitePieceFg : blackPieceFg;
                 cout << color << piece->getSymbol() << " " << reset;
             } 
             else 
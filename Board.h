@@ -2,6 +2,8 @@
 #define BOARD_H
 #include "Piece.h"
 #include "Square.h"
+#include "Bitboard.h"
+#include "Position.h"
 #include "pieces/Pawn.h"
 #include "pieces/Rook.h"
 #include "pieces/Knight.h"
@@ -11,17 +13,57 @@
 #include <stdexcept>
 class Board
 {
+    // Compatibility view handed out by getSquare, refreshed by syncSquares
     std::shared_ptr<Square> squares[8][8];
+    int viewCodes[64];
+
+    // Position core: one bitboard per piece code, occupancy per color
+    // and the piece code standing on every square (NO_PIECE if empty)
+    Bitboard pieceBitboards[12];
+    Bitboard occupancy[2];
+    uint8_t pieceCodes[64];
+
+    // Places a piece object, updating the position core and the Square view.
+    // Private since the engine's hash, king squares and scores would not follow.
+    void placePiece(int row, int col, std::shared_ptr<Piece> piece);
 
     public:
     Board();
+    Board(const Board& other);
+    Board& operator=(const Board& other);
     void initEmptyBoard(); 
     void setStartingPosition();
     std::shared_ptr<Square> getSquare(int row, int col);
     std::shared_ptr<Square> getSquare(const std::string& position);
     void printBoard() const;
+
+    // Position core mutators; they leave the Square view untouched
+    void addPiece(int square, int code);
+    void removePiece(int square);
+    void movePiece(int from, int to);
+
+    // Copy the piece placement to or from a Position snapshot; loading
+    // leaves the Square view untouched like the other core mutators
+    void savePieces(Position& position) const;
+    void loadPieces(const Position& position);
+
+    // Rebuilds the Square view where it differs from the position core.
+    // Kings and rooks report as moved once the castling rights they stand
+    // for are gone, other pieces once they left their starting square.
+    void syncSquares(int castlingRights = ALL_CASTLING);
+    static std::shared_ptr<Piece> createPiece(int code);
+    static int pieceCodeOf(const Piece& piece);
+
+    // Position core queries
+    Bitboard getPieces(Color color, PieceType type) const;
+    Bitboard getOccupancy(Color color) const;
+    Bitboard getOccupancy() const;
+    int getPieceCode(int square) const;
+    int getPieceCode(int row, int col) const;
+    bool isOccupied(int square) const;
+    bool isOccupied(int row, int col) const;
 };
 
 
 
-#endif
\ No newline at end of file
+#endif
@@ -1,14 +1,80 @@
 #include "ChessEngine.h"
+#include "Attacks.h"
+#include "Zobrist.h"
+#include "PerftTable.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <iostream>
+#include <sstream>
 
 using namespace std;
 
+// Castling rights that survive a move from or to the given square
+static int castlingMask(int square)
+{
+    switch(square)
+    {
+        case 0:  return ALL_CASTLING & ~BLACK_QUEENSIDE;                     // a8
+        case 4:  return ALL_CASTLING & ~(BLACK_KINGSIDE | BLACK_QUEENSIDE);  // e8
+        case 7:  return ALL_CASTLING & ~BLACK_KINGSIDE;                      // h8
+        case 56: return ALL_CASTLING & ~WHITE_QUEENSIDE;                     // a1
+        case 60: return ALL_CASTLING & ~(WHITE_KINGSIDE | WHITE_QUEENSIDE);  // e1
+        case 63: return ALL_CASTLING & ~WHITE_KINGSIDE;                      // h1
+        default: return ALL_CASTLING;
+    }
+}
+
+// Piece values for static exchange evaluation, indexed by piece type. The
+// king is never captured, so it costs nothing to put it on the square.
+static const int SEE_VALUES[6] = {100, 320, 330, 500, 900, 0};
+
 ChessEngine::ChessEngine()
 {
     board = make_shared<Board>();
-    currentTurn = "white";
+    currentTurn = WHITE;
+    castlingRights = ALL_CASTLING;
+    enPassantSquare = NO_SQUARE;
+    halfmoveClock = 0;
+    fullmoveNumber = 1;
+    statusValid = false;
     gameResult = make_shared<GameResult>();
     drawRequestedBy = "";
+    locateKings();
+    hash = computeHash();
+    scores = computeScores();
+}
+
+// An independent copy: the board and game result are cloned, not shared
+ChessEngine::ChessEngine(const ChessEngine& other)
+{
+    *this = other;
+}
+
+ChessEngine& ChessEngine::operator=(const ChessEngine& other)
+{
+    if(this == &other)
+    {
+        return *this;
+    }
+    this->board = make_shared<Board>(*other.board);
+    this->currentTurn = other.currentTurn;
+    this->moveLog = other.moveLog;
+    this->castlingRights = other.castlingRights;
+    this->board->syncSquares(this->castlingRights);
+    this->enPassantSquare = other.enPassantSquare;
+    this->kingSquares[WHITE] = other.kingSquares[WHITE];
+    this->kingSquares[BLACK] = other.kingSquares[BLACK];
+    this->halfmoveClock = other.halfmoveClock;
+    this->fullmoveNumber = other.fullmoveNumber;
+    this->hash = other.hash;
+    this->scores = other.scores;
+    this->network = other.network;
+    this->accumulators = other.accumulators;
+    this->statusValid = false;
+    this->drawRequestedBy = other.drawRequestedBy;
+    this->gameResult = make_shared<GameResult>(*other.gameResult);
+    return *this;
 }
     
     
@@ -19,14 +85,36 @@ shared_ptr<Board> ChessEngine::getBoard() const
 
 vector<Move> ChessEngine::getMoveLog() const 
 { 
-    return this->moveLog; 
+    // The log keeps packed moves; rebuild rich moves from the recorded pieces
+    vector<Move> moves;
+    for(const MoveRecord& record : this->moveLog)
+    {
+        int from = record.move.getFrom();
+        int to = record.move.getTo();
+        shared_ptr<Piece> pieceCaptured = nullptr;
+        if(record.pieceCaptured != NO_PIECE)
+        {
+            pieceCaptured = Board::createPiece(record.pieceCaptured);
+        }
+        Move move(this->board->getSquare(squareRow(from), squareCol(from)),
+                  this->board->getSquare(squareRow(to), squareCol(to)),
+                  Board::createPiece(record.pieceMoved), pieceCaptured);
+        this->setMoveFlags(move, record.move, pieceCodeColor(record.pieceMoved));
+        moves.push_back(move);
+    }
+    return moves;
 }
 
-string ChessEngine::getCurrentTurn() const 
+Color ChessEngine::getCurrentTurn() const 
 { 
     return this->currentTurn; 
 }
 
+string ChessEngine::getCurrentTurnName() const
+{
+    return colorName(this->currentTurn);
+}
+
 shared_ptr<GameResult> ChessEngine::getGameResult() const
 {
     return this->gameResult;
@@ -42,73 +130,46 @@ void ChessEngine::clearDrawRequest()
     this->drawRequestedBy = "";
 }
     
-void ChessEngine::setCurrentTurn(const string& currentTurn)
+void ChessEngine::setCurrentTurn(Color currentTurn)
 {
-    if((currentTurn != "white") && (currentTurn != "black"))
+    if(currentTurn != this->currentTurn)
     {
-        throw invalid_argument("current turn must be white or black");
+        // The en passant square only applies to the turn right after the
+        // double push, so a hand-made turn change drops it with its key
+        this->hash ^= zobristKeys.side ^ this->enPassantKey();
+        this->enPassantSquare = NO_SQUARE;
     }
     this->currentTurn = currentTurn;
+    this->statusValid = false;
+    assert(this->hash == this->computeHash());
 }
     
 void ChessEngine::makeMove(Move& move)
 {
     if(this->currentTurn != move.getPieceMoved()->getColor())
     {
-        throw invalid_argument("It is not " + move.getPieceMoved()->getColor() + " turn");
+        throw invalid_argument("It is not " + move.getPieceMoved()->getColorName() + " turn");
     }
-    shared_ptr<Piece> pieceMoved = move.getPieceMoved();
-    shared_ptr<Square> start = move.getStartSquare();
-    shared_ptr<Square> end = move.getEndSquare();
-    
-    if(move.getIsPawnPromotionMove())
+    this->makeMove(this->toPackedMove(move));
+}
+
+void ChessEngine::makeMove(PackedMove move)
+{
+    int pieceMoved = this->board->getPieceCode(move.getFrom());
+    if(pieceMoved == NO_PIECE)
     {
-        // For pawn promotion, place the promotion piece directly
-        shared_ptr<Piece> promotionPiece = move.getPawnPromotionPiece();
-        
-        if(promotionPiece == nullptr)
-        {
-            throw invalid_argument("Pawn promotion piece must be set before calling makeMove");
-        }
-        
-        end->setPiece(promotionPiece);
-        start->removePiece();
-        promotionPiece->setMoved(true);
+        throw invalid_argument("You can't move from an empty square");
     }
-    else
+    if(this->currentTurn != pieceCodeColor(pieceMoved))
     {
-        // Normal move
-        end->setPiece(pieceMoved);
-        start->removePiece();
-        pieceMoved->setMoved(true);
+        throw invalid_argument("It is not " + colorName(pieceCodeColor(pieceMoved)) + " turn");
     }
-    
-    if(move.getIsEnpassantMove()) // en passant move
-    {
-        move.getEnPassantCapturingSquare()->removePiece();
-    }
-    // Handle castling - move the rook as well
-    if(move.getIsKingSideCastle()) {
-        int row = start->getRow();
-        shared_ptr<Square> rookStart = this->board->getSquare(row, 7);
-        shared_ptr<Square> rookEnd = this->board->getSquare(row, 5);
-        shared_ptr<Piece> rook = rookStart->getPiece();
-        rookEnd->setPiece(rook);
-        rookStart->removePiece();
-        rook->setMoved(true);
-    }
-    if(move.getIsQueenSideCastle()) {
-        int row = start->getRow();
-        shared_ptr<Square> rookStart = this->board->getSquare(row, 0);
-        shared_ptr<Square> rookEnd = this->board->getSquare(row, 3);
-        shared_ptr<Piece> rook = rookStart->getPiece();
-        rookEnd->setPiece(rook);
-        rookStart->removePiece();
-        rook->setMoved(true);
-    }
-    this->currentTurn = this->currentTurn == "white" ? "black" : "white";
-    this->moveLog.push_back(move);
-       
+    if(!this->isLegal(move))
+    {
+        throw invalid_argument("Illegal move: " + move.toString());
+    }
+    this->makeMoveUnchecked(move);
+    this->board->syncSquares(this->castlingRights);
 }
     
 void ChessEngine::undoMove()
@@ -117,727 +178,1375 @@ void ChessEngine::undoMove()
     {
         throw invalid_argument("Cannot undo move from starting position");
     }
-    Move lastMove = this->moveLog.back(); 
-    this->moveLog.pop_back();
-    shared_ptr<Piece> pieceMoved = lastMove.getPieceMoved();
-    shared_ptr<Piece> pieceCaptured = lastMove.getPieceCaptured();
-    shared_ptr<Square> start = lastMove.getStartSquare();
-    shared_ptr<Square> end = lastMove.getEndSquare();
-    if(lastMove.getIsEnpassantMove()) // undo en passant move
-    {
-        start->setPiece(pieceMoved);
-        end->removePiece();     
-        lastMove.getEnPassantCapturingSquare()->setPiece(pieceCaptured);
-        pieceMoved->setMoved(lastMove.getHadPieceBeenMoved());
-        this->currentTurn = this->currentTurn == "white" ? "black" : "white";
-        return;
-    }
-    // Handle undoing castling
-    if(lastMove.getIsKingSideCastle() || lastMove.getIsQueenSideCastle()) {
-        int row = start->getRow();
-        start->setPiece(pieceMoved);
-        end->removePiece();
-        pieceMoved->setMoved(lastMove.getHadPieceBeenMoved());
-        
-        if(lastMove.getIsKingSideCastle()) 
-        {
-            shared_ptr<Square> rookEnd = this->board->getSquare(row, 5);
-            shared_ptr<Square> rookStart = this->board->getSquare(row, 7);
-            shared_ptr<Piece> rook = rookEnd->getPiece();
-            rookStart->setPiece(rook);
-            rookEnd->removePiece();
-            rook->setMoved(false);
-        } 
-        else 
-        { // queenside castle
-            shared_ptr<Square> rookEnd = this->board->getSquare(row, 3);
-            shared_ptr<Square> rookStart = this->board->getSquare(row, 0);
-            shared_ptr<Piece> rook = rookEnd->getPiece();
-            rookStart->setPiece(rook);
-            rookEnd->removePiece();
-            rook->setMoved(false);
-        }
-        
-        this->currentTurn = this->currentTurn == "white" ? "black" : "white";
-        return;
-    }
-    // pawn promotion is the same undo move as normal move
-    start->setPiece(pieceMoved);
-    end->setPiece(pieceCaptured);
-    pieceMoved->setMoved(lastMove.getHadPieceBeenMoved());
-    this->currentTurn = this->currentTurn == "white" ? "black" : "white";
+    this->undoMoveUnchecked();
+    this->board->syncSquares(this->castlingRights);
 }
     
-shared_ptr<Square> ChessEngine::findKing(const string& color) const
+shared_ptr<Square> ChessEngine::findKing(Color color) const
 {
-    for(int row = 0; row<8; row++) 
+    int square = this->getKingSquare(color);
+    if(square == NO_SQUARE)
     {
-        for(int col = 0; col < 8; col++) 
-        {
-            shared_ptr<Square> square = this->board->getSquare(row, col);
-            if(square->hasPiece()) 
-            {
-                shared_ptr<Piece> piece = square->getPiece();
-                if(piece->getType() == "King" && piece->getColor() == color) 
-                {
-                    return square;
-                }
-            }
-        }
-    }
-    throw out_of_range("King not found for color: " + color);
-}
-   
-// Check if a square is under attack by the specified color
-bool ChessEngine::isSquareUnderAttack(int row, int col, const string& byColor)
-{
- // Save current turn
-    string originalTurn = this->currentTurn;
-        
-    // Temporarily switch turn to get opponent's moves
-    this->currentTurn = byColor;
-        
-    // Get all possible moves for the attacking color (not legal moves to avoid recursion)
-    vector<Move> opponentMoves = this->getAllPossibleMoves();
-        
-    // Restore original turn
-    this->currentTurn = originalTurn;
-        
-    // Check if any opponent move targets this square
-    for(const auto& move : opponentMoves) 
-    {
-        if(move.getEndSquare()->getRow() == row && move.getEndSquare()->getCol() == col) 
-        {
-            return true;
-        }
-    }
-        
-    return false;
-}
-    
-bool ChessEngine::isInCheck(const string& color)
-{
-    shared_ptr<Square> kingSquare = this->findKing(color);
-    string opponentColor = color == "white" ? "black" : "white";
-    return this->isSquareUnderAttack(kingSquare->getRow(), kingSquare->getCol(), opponentColor);
-}
-    
-vector<Move> ChessEngine::getAllLegalMoves()
-{
-    vector<Move> possibleMoves = this->getAllPossibleMoves();
-    vector<Move> legalMoves;
-        
-    // Test each move to see if it leaves the king in check
-    for(Move move : possibleMoves) 
-    {
-        // Special handling for castling - check that king doesn't castle through check
-        if(move.getIsKingSideCastle() || move.getIsQueenSideCastle()) {
-            string kingColor = move.getPieceMoved()->getColor();
-            string opponentColor = kingColor == "white" ? "black" : "white";
-            int row = move.getStartSquare()->getRow();
-            int startCol = move.getStartSquare()->getCol();
-            
-            // King cannot castle out of check
-            if(this->isInCheck(kingColor)) 
-            {
-                continue;
-            }
-            
-            // Check intermediate square(s)
-            bool passesThroughCheck = false;
-            if(move.getIsKingSideCastle()) 
-            {
-                // King moves from col 4 to col 6, passing through col 5
-                if (this->isSquareUnderAttack(row, startCol + 1, opponentColor)) 
-                {
-                    passesThroughCheck = true;
-                }
-            } 
-            else 
-            { 
-                // Queenside castle
-                // King moves from col 4 to col 2, passing through col 3
-                if(this->isSquareUnderAttack(row, startCol - 1, opponentColor)) {
-                    passesThroughCheck = true;
-                }
-            }
-            
-            if(passesThroughCheck) 
-            {
-                continue;
-            }
-        }
-        
-        // Make the move temporarily
-        try 
-        {
-            this->makeMoveTesting(move);
-            
-            // Check if this leaves our king in check
-            if(!this->isInCheck(move.getPieceMoved()->getColor())) 
-            {
-                legalMoves.push_back(move);
-            }
-            
-            // Undo the move
-            this->undoMoveTesting();
-        } 
-        catch(exception e) 
-        {
-            // If there's an error, skip this move
-            try 
-            {
-                // Try to undo anyway
-                if(!this->moveLog.empty()) 
-                {
-                    this->undoMoveTesting();
-                }
-            } 
-            catch(exception undoError) 
-            {
-                // Ignore undo errors
-            }
-        }
+        throw out_of_range("King not found for color: " + colorName(color));
     }
-        
-    return legalMoves;
-}
-    
-bool ChessEngine::isCheckmate()
-{
-    return this->getAllLegalMoves().empty() && this->isInCheck(this->currentTurn);
+    return this->board->getSquare(squareRow(square), squareCol(square));
 }
-    
-bool ChessEngine::isStalemate()
+
+// Kept up to date by make/undo, so this is a plain read
+int ChessEngine::getKingSquare(Color color) const
 {
-    return this->getAllLegalMoves().empty() && !this->isInCheck(this->currentTurn);
+    return this->kingSquares[color];
 }
-    
-vector<Move> ChessEngine::getAllPossibleMoves()
+
+// Sets up the position described by a FEN string and clears the move log
+void ChessEngine::loadFEN(const string& fen)
 {
-    vector<Move> possibleMoves;
-    string cols = "abcdefgh";
-    string rows = "87654321";
-    for(int r = 0; r < rows.length(); r++) 
+    istringstream fields(fen);
+    string placement, side, castling, enPassant;
+    int halfmoves = 0;
+    int fullmoves = 1;
+    if(!(fields >> placement >> side))
     {
-        for(int c = 0; c < cols.length(); c++) 
-        {
-            shared_ptr<Square> currentSquare = this->board->getSquare(r, c);
-            shared_ptr<Piece> currentPiece = currentSquare->getPiece();
-            if(currentPiece != nullptr)
-            {
-                if(currentPiece->getColor() == this->currentTurn)
-                {
-                    if(currentPiece->getType() == "Pawn")
-                    {
-                        this->getPawnMoves(currentSquare, possibleMoves);
-                    }
-                    if(currentPiece->getType() == "Rook")
-                    {
-                        this->getRookMoves(currentSquare, possibleMoves);
-                    }
-                    if(currentPiece->getType() == "Bishop")
-                    {
-                        this->getBishopMoves(currentSquare, possibleMoves);
-                    }
-                    if(currentPiece->getType() == "Queen")
-                    {
-                        this->getQueenMoves(currentSquare, possibleMoves);
-                    }
-                    if(currentPiece->getType() == "Knight")
-                    {
-                        this->getKnightMoves(currentSquare, possibleMoves);
-                    }
-                    if(currentPiece->getType() == "King")
-                    {
-                        this->getKingMoves(currentSquare, possibleMoves);
-                    }
-                }
-            }
-        }
+        throw invalid_argument("FEN needs at least piece placement and side to move: " + fen);
     }
+    fields >> castling >> enPassant >> halfmoves >> fullmoves;
 
-    return possibleMoves;
-} 
-    
-void ChessEngine::getPawnMoves(const shared_ptr<Square> startSquare, vector<Move>& possibleMoves)
-{
-    auto pawn = static_pointer_cast<Pawn>(startSquare->getPiece());
-    vector<vector<int>> possiblePawnMoves = pawn->getPossibleMoves(startSquare->getRow(), startSquare->getCol());
-    for(const auto& moveCoords : possiblePawnMoves)
+    shared_ptr<Board> newBoard = make_shared<Board>();
+    newBoard->initEmptyBoard();
+    int row = 0;
+    int col = 0;
+    for(char c : placement)
     {
-        int newRow = moveCoords[0];
-        int newCol = moveCoords[1];
-        
-        shared_ptr<Square> targetSquare = this->board->getSquare(newRow, newCol);
-        shared_ptr<Piece> targetPiece = targetSquare->getPiece();
-
-        bool sameColumn = (newCol == startSquare->getCol());
-        bool diagonalMove = abs(newCol - startSquare->getCol()) == 1;
-        bool moveAdded = false;
-        if(sameColumn)
+        if(c == '/')
         {
-            if(targetPiece != nullptr) continue;
-            if(abs(newRow - startSquare->getRow()) == 2)
+            if(col != 8)
             {
-                int midRow = (newRow + startSquare->getRow()) / 2;
-                if(board->getSquare(midRow, newCol)->getPiece() != nullptr) continue;
+                throw invalid_argument("Invalid FEN piece placement: " + placement);
             }
-            possibleMoves.push_back(Move(startSquare, targetSquare));
-            moveAdded = true;
+            row++;
+            col = 0;
+            continue;
         }
-        if(diagonalMove)
+        if(c >= '1' && c <= '8')
         {
-            if(targetPiece == nullptr)
+            col += c - '0';
+            if(col > 8)
             {
-                //en passant 
-                if(!this->moveLog.empty()) 
-                {
-                    const Move& lastMove = this->moveLog.back();
-                    if(lastMove.getPieceMoved()->getType() == "Pawn")
-                    {
-                        int pawnRow = startSquare->getRow();
-                        int pawnCol = startSquare->getCol();
-                        int lastStartRow = lastMove.getStartSquare()->getRow();
-                        int lastEndRow = lastMove.getEndSquare()->getRow();
-                        int lastEndCol = lastMove.getEndSquare()->getCol();
-
-                        if(abs(lastStartRow - lastEndRow) == 2 && lastEndRow == pawnRow && lastEndCol == newCol) 
-                        {
-                            
-                            if(abs(lastEndCol - pawnCol) == 1) 
-                            {
-                                int direction = (pawn->getColor() == "white") ? -1 : 1;
-                                int epRow = pawnRow + direction;
-                                int epCol = lastEndCol; 
-                            
-                                shared_ptr<Square> epSquare = this->board->getSquare(epRow, epCol);
-                                if(!epSquare->hasPiece()) 
-                                {
-                                    Move enPassantMove(startSquare, epSquare);
-                                    enPassantMove.setEnpassant();
-                                    enPassantMove.setPieceCaptured(lastMove.getPieceMoved());
-                                    enPassantMove.setEnPassantCapturingSquare(lastMove.getEndSquare());
-                                    possibleMoves.push_back(enPassantMove);
-                                }
-                            }    
-                        }
-                    }
-                }
-                continue;
-            }
-
-            if(targetPiece->getColor() != pawn->getColor())
-            {
-                possibleMoves.push_back(Move(startSquare, targetSquare));
-                moveAdded = true;
+                throw invalid_argument("Invalid FEN piece placement: " + placement);
             }
+            continue;
         }
-        if(moveAdded) // pawn promotion
+        size_t type = string("pnbrqk").find(tolower(c));
+        if(type == string::npos || row > 7 || col > 7)
         {
-            Move lastAddedMove = possibleMoves.back(); // Make a copy instead of reference
-            int moveRow = lastAddedMove.getEndSquare()->getRow();
-            if(moveRow == 0 || moveRow == 7)
-            {
-                string color = lastAddedMove.getPieceMoved()->getColor();
-                
-                // Remove the move we just added since we'll replace it with 4 promotion options
-                possibleMoves.pop_back();
-                
-                // Create the four promotion moves
-                // NOTE: We set promotion pieces to nullptr initially
-                // They will be created fresh when the move is actually made
-                Move pawnToQueen = lastAddedMove;
-                pawnToQueen.setPawnPromotion();
-                pawnToQueen.setPawnPromotionPiece(nullptr); // Will be set later
-                possibleMoves.push_back(pawnToQueen);
-
-                Move pawnToRook = lastAddedMove; 
-                pawnToRook.setPawnPromotion();
-                pawnToRook.setPawnPromotionPiece(nullptr);
-                possibleMoves.push_back(pawnToRook);
-
-                Move pawnToBishop = lastAddedMove;
-                pawnToBishop.setPawnPromotion();
-                pawnToBishop.setPawnPromotionPiece(nullptr);
-                possibleMoves.push_back(pawnToBishop);
-
-                Move pawnToKnight = lastAddedMove;
-                pawnToKnight.setPawnPromotion();
-                pawnToKnight.setPawnPromotionPiece(nullptr);
-                possibleMoves.push_back(pawnToKnight);
-            }
+            throw invalid_argument("Invalid FEN piece placement: " + placement);
         }
-
+        newBoard->addPiece(makeSquareIndex(row, col), makePieceCode(isupper(c) ? WHITE : BLACK, static_cast<PieceType>(type)));
+        col++;
+    }
+    if(row != 7 || col != 8)
+    {
+        throw invalid_argument("Invalid FEN piece placement: " + placement);
+    }
+    // Move generation relies on exactly one king per side
+    if(popCount(newBoard->getPieces(WHITE, KING)) != 1 || popCount(newBoard->getPieces(BLACK, KING)) != 1)
+    {
+        throw invalid_argument("FEN needs exactly one king per side: " + placement);
+    }
+    if(side != "w" && side != "b")
+    {
+        throw invalid_argument("Invalid FEN side to move: " + side);
     }
-            
-}
-
-void ChessEngine::getRookMoves(const shared_ptr<Square> startSquare, vector<Move>& possibleMoves)
-{
-    int row = startSquare->getRow();
-    int col = startSquare->getCol();
-    string myColor = startSquare->getPiece()->getColor();
-
-    int directions[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
 
-    for(auto& dir : directions) 
+    int rights = 0;
+    for(char c : castling)
+    {
+        if(c == 'K') rights |= WHITE_KINGSIDE;
+        if(c == 'Q') rights |= WHITE_QUEENSIDE;
+        if(c == 'k') rights |= BLACK_KINGSIDE;
+        if(c == 'q') rights |= BLACK_QUEENSIDE;
+    }
+    // Keep only the rights whose king and rook are still on their home squares
+    static const int HOME_SQUARES[6] = {0, 4, 7, 56, 60, 63};
+    static const PieceType HOME_TYPES[6] = {ROOK, KING, ROOK, ROOK, KING, ROOK};
+    for(int i = 0; i < 6; i++)
     {
-        for(int i = 1; i < 8; i++) 
+        Color color = HOME_SQUARES[i] < 8 ? BLACK : WHITE;
+        if(newBoard->getPieceCode(HOME_SQUARES[i]) != makePieceCode(color, HOME_TYPES[i]))
         {
-            int nRow = row + dir[0] * i;
-            int nCol = col + dir[1] * i;
-
-            if(nRow >= 0 && nRow < 8 && nCol >= 0 && nCol < 8) 
-            {
-                shared_ptr<Square> targetSquare = this->board->getSquare(nRow, nCol);
-                
-                if(!targetSquare->hasPiece()) 
-                {
-                    possibleMoves.push_back(Move(startSquare, targetSquare));
-                } 
-                else 
-                {
-                    if(targetSquare->getPiece()->getColor() != myColor) 
-                    {
-                        possibleMoves.push_back(Move(startSquare, targetSquare));
-                    }
-                    break; 
-                }    
-            } 
-            else 
-            {
-                break; 
-            }
+            rights &= castlingMask(HOME_SQUARES[i]);
         }
     }
-}
-    
-void ChessEngine::getBishopMoves(const shared_ptr<Square> startSquare, vector<Move>& possibleMoves)
-{
-    int row = startSquare->getRow();
-    int col = startSquare->getCol();
-    string myColor = startSquare->getPiece()->getColor();
 
-    int directions[4][2] = {{1, 1}, {-1, 1}, {1, -1}, {-1, -1}};
-
-    for(auto& dir : directions) 
+    int epSquare = NO_SQUARE;
+    if(enPassant.size() == 2 && enPassant[0] >= 'a' && enPassant[0] <= 'h' && enPassant[1] >= '1' && enPassant[1] <= '8')
     {
-        for(int i = 1; i < 8; i++) 
-        {
-            int nRow = row + dir[0] * i;
-            int nCol = col + dir[1] * i;
-
-            if(nRow >= 0 && nRow < 8 && nCol >= 0 && nCol < 8) 
-            {
-                shared_ptr<Square> targetSquare = this->board->getSquare(nRow, nCol);
-                
-                if(!targetSquare->hasPiece()) 
-                {
-                    possibleMoves.push_back(Move(startSquare, targetSquare));
-                } 
-                else 
-                {
-                    if(targetSquare->getPiece()->getColor() != myColor) 
-                    {
-                        possibleMoves.push_back(Move(startSquare, targetSquare));
-                    }
-                    break; 
-                }    
-            } 
-            else 
-            {
-                break; 
-            }
-        }
+        epSquare = makeSquareIndex('8' - enPassant[1], enPassant[0] - 'a');
+    }
+    // The square a pawn just skipped: rank 6 with white to move, rank 3 with black
+    if(epSquare != NO_SQUARE && squareRow(epSquare) != (side == "w" ? 2 : 5))
+    {
+        epSquare = NO_SQUARE;
     }
+
+    this->board = newBoard;
+    this->currentTurn = side == "w" ? WHITE : BLACK;
+    this->castlingRights = rights;
+    this->board->syncSquares(this->castlingRights);
+    this->enPassantSquare = epSquare;
+    this->halfmoveClock = halfmoves;
+    this->fullmoveNumber = fullmoves;
+    this->moveLog.clear();
+    this->gameResult = make_shared<GameResult>();
+    this->drawRequestedBy = "";
+    this->locateKings();
+    this->hash = this->computeHash();
+    this->scores = this->computeScores();
+    this->refreshAccumulators();
+    this->statusValid = false;
 }
-    
-void ChessEngine::getQueenMoves(const shared_ptr<Square> startSquare, vector<Move>& possibleMoves)
+
+int ChessEngine::getHalfmoveClock() const
 {
-    getRookMoves(startSquare, possibleMoves);
-    getBishopMoves(startSquare, possibleMoves);
+    return this->halfmoveClock;
 }
-    
-void ChessEngine::getKnightMoves(const shared_ptr<Square> startSquare, vector<Move>& possibleMoves)
+
+int ChessEngine::getFullmoveNumber() const
 {
-    auto knight = static_pointer_cast<Knight>(startSquare->getPiece());
-    
-    vector<vector<int>> possibleKnightMoves = knight->getPossibleMoves(startSquare->getRow(), startSquare->getCol());  
+    return this->fullmoveNumber;
+}
 
-    for(const auto& move : possibleKnightMoves)
-    {
-        int newRow = move[0];
-        int newCol = move[1];
+Position ChessEngine::getPosition() const
+{
+    Position position;
+    this->board->savePieces(position);
+    position.hash = this->hash;
+    position.sideToMove = static_cast<uint8_t>(this->currentTurn);
+    position.castlingRights = static_cast<uint8_t>(this->castlingRights);
+    position.enPassantSquare = static_cast<uint8_t>(this->enPassantSquare);
+    position.halfmoveClock = static_cast<uint8_t>(this->halfmoveClock < 255 ? this->halfmoveClock : 255);
+    position.fullmoveNumber = static_cast<uint16_t>(this->fullmoveNumber);
+    position.kingSquares[WHITE] = static_cast<uint8_t>(this->kingSquares[WHITE]);
+    position.kingSquares[BLACK] = static_cast<uint8_t>(this->kingSquares[BLACK]);
+    position.scores = this->scores;
+    return position;
+}
 
-        shared_ptr<Square> targetSquare = this->board->getSquare(newRow, newCol);
-        shared_ptr<Piece> targetPiece = targetSquare->getPiece();
+// A position setup path: the snapshot already carries the king squares, hash
+// and scores, and the Square view and accumulators are brought up to date
+// only when something needs them
+void ChessEngine::setPosition(const Position& position)
+{
+    this->board->loadPieces(position);
+    this->currentTurn = static_cast<Color>(position.sideToMove);
+    this->castlingRights = position.castlingRights;
+    this->enPassantSquare = position.enPassantSquare;
+    this->halfmoveClock = position.halfmoveClock;
+    this->fullmoveNumber = position.fullmoveNumber;
+    this->kingSquares[WHITE] = position.kingSquares[WHITE];
+    this->kingSquares[BLACK] = position.kingSquares[BLACK];
+    this->hash = position.hash;
+    this->scores = position.scores;
+    this->statusValid = false;
+    this->moveLog.clear();
+    this->accumulators.clear();
+    this->gameResult = make_shared<GameResult>();
+    this->drawRequestedBy = "";
+    assert(this->hash == this->computeHash());
+    assert(this->scores == this->computeScores());
+}
 
-        if(targetPiece == nullptr)
-        {
-            possibleMoves.push_back(Move(startSquare, targetSquare));
-        }
-        else
-        {
-            if(targetPiece->getColor() != knight->getColor())
-            {
-                possibleMoves.push_back(Move(startSquare, targetSquare));
-            }
-        }
+// Counts the leaf nodes of the legal move tree to the given depth
+uint64_t ChessEngine::perft(int depth)
+{
+    if(depth <= 0)
+    {
+        return 1;
+    }
+    MoveList moves;
+    this->generateLegalMoves(moves);
+    if(depth == 1)
+    {
+        return moves.size();
     }
+    uint64_t nodes = 0;
+    for(PackedMove move : moves)
+    {
+        this->makeMoveUnchecked(move);
+        nodes += this->perft(depth - 1);
+        this->undoMoveUnchecked();
+    }
+    return nodes;
 }
-    
-void ChessEngine::getKingMoves(const shared_ptr<Square> startSquare, vector<Move>& possibleMoves)
+
+// Perft that reuses the counts of transposed subtrees. The last ply is
+// bulk counted, so only depths of two or more go through the table.
+uint64_t ChessEngine::perft(int depth, PerftTable& table)
 {
-    auto king = static_pointer_cast<King>(startSquare->getPiece());
-    
-    vector<vector<int>> possibleKingMoves = king->getPossibleMoves(startSquare->getRow(), startSquare->getCol());
-    for(const auto& coords : possibleKingMoves) 
-    {
-        int newRow = coords[0];
-        int newCol = coords[1];
-        
-        shared_ptr<Square> targetSquare = this->board->getSquare(newRow, newCol);
-        shared_ptr<Piece> targetPiece = targetSquare->getPiece();
-        
-        if(targetPiece == nullptr) 
-        {
-            possibleMoves.push_back(Move(startSquare, targetSquare));
-        } 
-        else
-        {
-            if(targetPiece->getColor() != king->getColor()) 
-            {
-                possibleMoves.push_back(Move(startSquare, targetSquare));
-            }
-        }
+    if(depth <= 1)
+    {
+        return this->perft(depth);
     }
-
-    if(!king->hasMoved()) 
+    uint64_t nodes = 0;
+    if(table.probe(this->hash, depth, nodes))
     {
-        int kingRow = startSquare->getRow();
-        int kingCol = startSquare->getCol();
-
-        shared_ptr<Square> kingsideRookSquare = this->board->getSquare(kingRow, 7);
-        if(kingsideRookSquare->hasPiece() && 
-            kingsideRookSquare->getPiece()->getType() == "Rook" &&
-            kingsideRookSquare->getPiece()->getColor() == king->getColor() &&
-            !kingsideRookSquare->getPiece()->hasMoved()) 
-        {
-            bool pathClear = true;
-            for(int col = kingCol + 1; col<7; col++) 
-            {
-                if(this->board->getSquare(kingRow, col)->hasPiece()) 
-                {
-                    pathClear = false;
-                    break;
-                }
-            }
-
-            if(pathClear) 
-            {
-                shared_ptr<Square> targetSquare = this->board->getSquare(kingRow, kingCol + 2);
-                Move castleMove(startSquare, targetSquare);
-                castleMove.setKingSideCastle(); 
-                possibleMoves.push_back(castleMove);
-            }
-        }
-
-        shared_ptr<Square> queensideRookSquare = this->board->getSquare(kingRow, 0);
-        if(queensideRookSquare->hasPiece() && 
-            queensideRookSquare->getPiece()->getType() == "Rook" &&
-            queensideRookSquare->getPiece()->getColor() == king->getColor() &&
-            !queensideRookSquare->getPiece()->hasMoved()) 
-        {
-
-            bool pathClear = true;
-            for(int col = 1; col<kingCol; col++) 
-            {
-                if(this->board->getSquare(kingRow, col)->hasPiece()) 
-                {
-                    pathClear = false;
-                    break;
-                }
-            }
+        return nodes;
+    }
+    MoveList moves;
+    this->generateLegalMoves(moves);
+    for(PackedMove move : moves)
+    {
+        this->makeMoveUnchecked(move);
+        nodes += this->perft(depth - 1, table);
+        this->undoMoveUnchecked();
+    }
+    table.store(this->hash, depth, nodes);
+    return nodes;
+}
 
-            if(pathClear) 
-            {
-                shared_ptr<Square> targetSquare = this->board->getSquare(kingRow, kingCol - 2);
-                Move castleMove(startSquare, targetSquare);
-                castleMove.setQueenSideCastle();
-                possibleMoves.push_back(castleMove);
-            }
-        }
+// Reads both king squares from the board; every position setup path must call this
+void ChessEngine::locateKings()
+{
+    for(Color color : {WHITE, BLACK})
+    {
+        Bitboard king = this->board->getPieces(color, KING);
+        this->kingSquares[color] = king ? lowestSquare(king) : NO_SQUARE;
     }
 }
-    
-void ChessEngine::resign()
+   
+// Check if a square is under attack by the specified color
+bool ChessEngine::isSquareUnderAttack(int row, int col, Color byColor) const
 {
-    string winner = this->currentTurn == "white" ? "BLACK" : "WHITE";
-    GameResult::ResultType resultType = (this->currentTurn == "white") ? 
-        GameResult::ResultType::WHITE_RESIGNED : GameResult::ResultType::BLACK_RESIGNED;
-    this->gameResult->setResult(resultType, this->currentTurn + " resigned");
+    return this->isSquareUnderAttack(makeSquareIndex(row, col), byColor);
 }
-    
-bool ChessEngine::requestDraw()
+
+bool ChessEngine::isSquareUnderAttack(int square, Color byColor) const
 {
-    if(this->drawRequestedBy == "")
+    return this->isSquareAttacked(square, byColor, this->board->getOccupancy());
+}
+
+// Looks outward from the square: a piece attacks it exactly when the same
+// kind of piece standing on the square would attack the piece back. Sliders
+// are blocked by the given occupancy rather than the board's.
+bool ChessEngine::isSquareAttacked(int square, Color byColor, Bitboard occupied) const
+{
+    if(pawnAttacks(oppositeColor(byColor), square) & this->board->getPieces(byColor, PAWN))
     {
-        this->drawRequestedBy = this->currentTurn;
-        return false;
+        return true;
     }
-    else if(this->drawRequestedBy == this->currentTurn)
+    if(knightAttacks(square) & this->board->getPieces(byColor, KNIGHT))
     {
-        return false;
+        return true;
     }
-    else
+    if(kingAttacks(square) & this->board->getPieces(byColor, KING))
+    {
+        return true;
+    }
+    Bitboard queens = this->board->getPieces(byColor, QUEEN);
+    if(bishopAttacks(square, occupied) & (this->board->getPieces(byColor, BISHOP) | queens))
     {
-        this->gameResult->setResult(GameResult::ResultType::DRAW, "Draw agreed by both players");
-        this->drawRequestedBy = "";
         return true;
     }
+    return (rookAttacks(square, occupied) & (this->board->getPieces(byColor, ROOK) | queens)) != 0;
 }
-    
-void ChessEngine::acceptDraw()
+
+// Every piece of the given color attacking the square
+Bitboard ChessEngine::attackersTo(int square, Color byColor, Bitboard occupied) const
 {
-    if(this->drawRequestedBy == "") 
+    Bitboard queens = this->board->getPieces(byColor, QUEEN);
+    return (pawnAttacks(oppositeColor(byColor), square) & this->board->getPieces(byColor, PAWN)) |
+           (knightAttacks(square) & this->board->getPieces(byColor, KNIGHT)) |
+           (kingAttacks(square) & this->board->getPieces(byColor, KING)) |
+           (bishopAttacks(square, occupied) & (this->board->getPieces(byColor, BISHOP) | queens)) |
+           (rookAttacks(square, occupied) & (this->board->getPieces(byColor, ROOK) | queens));
+}
+
+// Pieces of the given color that are the only blocker between their king and an enemy slider
+Bitboard ChessEngine::pinnedPieces(Color color, int kingSquare) const
+{
+    Color opponentColor = oppositeColor(color);
+    Bitboard queens = this->board->getPieces(opponentColor, QUEEN);
+    Bitboard snipers = (rookAttacks(kingSquare, 0) & (this->board->getPieces(opponentColor, ROOK) | queens)) |
+                       (bishopAttacks(kingSquare, 0) & (this->board->getPieces(opponentColor, BISHOP) | queens));
+    Bitboard occupied = this->board->getOccupancy();
+    Bitboard pinned = 0;
+    while(snipers)
     {
-        throw std::runtime_error("No draw request to accept");
-    }
-    if(this->drawRequestedBy == this->currentTurn) {
-        throw std::runtime_error("You cannot accept your own draw request");
+        Bitboard blockers = squaresBetween(kingSquare, popLowestSquare(snipers)) & occupied;
+        if(popCount(blockers) == 1)
+        {
+            pinned |= blockers & this->board->getOccupancy(color);
+        }
     }
-
-    this->gameResult->setResult(GameResult::ResultType::DRAW, "Draw agreed by both players");
-    this->drawRequestedBy = "";
+    return pinned;
 }
     
-void ChessEngine::declineDraw()
-{   
-    if(this->drawRequestedBy == "") 
+bool ChessEngine::isInCheck(Color color) const
+{
+    int kingSquare = this->kingSquares[color];
+    if(kingSquare == NO_SQUARE)
     {
-        throw std::runtime_error("No draw request to decline");
+        throw out_of_range("King not found for color: " + colorName(color));
     }
-    this->drawRequestedBy = "";
+    return this->isSquareUnderAttack(kingSquare, oppositeColor(color));
+}
+    
+vector<Move> ChessEngine::getAllLegalMoves()
+{
+    vector<Move> moves;
+    this->appendMoves(this->evaluateStatus().legalMoves, moves);
+    return moves;
 }
 
-void ChessEngine::makeMoveTesting(Move move)
+// Emits only legal moves. Checkers and pinned pieces are found once; in
+// check the work is handed to the evasion generator, otherwise every piece
+// is limited to its pin line if it is pinned. The type limits the pass to
+// captures and promotions or to the remaining quiet moves.
+void ChessEngine::generateLegalMoves(MoveList& legalMoves, MoveGenType type)
 {
-    shared_ptr<Piece> pieceMoved = move.getPieceMoved();
-    shared_ptr<Square> start = move.getStartSquare();
-    shared_ptr<Square> end = move.getEndSquare();
-    
-    // Store the original moved status of the piece that's actually moving
-    bool hadMoved = pieceMoved->hasMoved();
-    move.setHadPieceBeenMoved(hadMoved);
-    
-    if(move.getIsPawnPromotionMove()) 
+    Color color = this->currentTurn;
+    int kingSquare = this->kingSquares[color];
+    Bitboard checkers = this->attackersTo(kingSquare, oppositeColor(color), this->board->getOccupancy());
+    if(checkers)
     {
-        // For pawn promotion testing, just promote to queen for simplicity
-        // The actual promotion piece will be set when the move is really made
-        shared_ptr<Piece> promotionPiece = move.getPawnPromotionPiece();
-        if(promotionPiece == nullptr)
-        {
-            // Create a temporary queen for testing purposes
-            promotionPiece = make_shared<Queen>(pieceMoved->getColor());
-        }
-        end->setPiece(promotionPiece);
-        start->removePiece();
-        promotionPiece->setMoved(true);
+        this->generateCheckEvasions(checkers, type, legalMoves);
+        return;
     }
-    else
+
+    this->generateSafeKingMoves(this->targetSquares(type), legalMoves);
+    if(type != CAPTURES)
     {
-        // Normal move
-        end->setPiece(pieceMoved);
-        start->removePiece();
-        pieceMoved->setMoved(true);
+        this->generateCastlingMoves(kingSquare, true, legalMoves);
     }
 
-    if(move.getIsEnpassantMove()) 
+    Bitboard pinned = this->pinnedPieces(color, kingSquare);
+    Bitboard pieces = this->board->getOccupancy(color) & ~squareBitboard(kingSquare);
+    while(pieces)
     {
-        shared_ptr<Square> captureSquare = move.getEnPassantCapturingSquare();
-        if(captureSquare) 
+        int square = popLowestSquare(pieces);
+        Bitboard pieceAllowed = ALL_SQUARES;
+        if(pinned & squareBitboard(square))
         {
-            captureSquare->removePiece();
+            pieceAllowed = lineThrough(kingSquare, square);
         }
+        this->generatePieceMoves(square, pieceAllowed, type, legalMoves);
     }
-    if(move.getIsKingSideCastle()) 
+
+    if(type != QUIETS)
     {
-        int row = start->getRow();
-        shared_ptr<Square> rookStart = this->board->getSquare(row, 7);
-        shared_ptr<Square> rookEnd = this->board->getSquare(row, 5);
-        shared_ptr<Piece> rook = rookStart->getPiece();
-        rookEnd->setPiece(rook);
-        rookStart->removePiece();
-        rook->setMoved(true);
+        this->generateEnPassantMoves(true, legalMoves);
     }
-    if(move.getIsQueenSideCastle()) 
+}
+
+// Legal captures and promotions only
+void ChessEngine::generateCaptures(MoveList& captures)
+{
+    this->generateLegalMoves(captures, CAPTURES);
+}
+
+// Legal moves out of check; emits nothing when the side to move is not in check
+void ChessEngine::generateEvasions(MoveList& evasions)
+{
+    Color color = this->currentTurn;
+    Bitboard checkers = this->attackersTo(this->kingSquares[color], oppositeColor(color), this->board->getOccupancy());
+    if(checkers)
     {
-        int row = start->getRow();
-        shared_ptr<Square> rookStart = this->board->getSquare(row, 0);
-        shared_ptr<Square> rookEnd = this->board->getSquare(row, 3);
-        shared_ptr<Piece> rook = rookStart->getPiece();
-        rookEnd->setPiece(rook);
-        rookStart->removePiece();
-        rook->setMoved(true);
+        this->generateCheckEvasions(checkers, ALL_MOVES, evasions);
     }
-    this->moveLog.push_back(move);
+}
+
+// The king steps out of check, or a single checker is captured or blocked.
+// Pinned pieces are skipped outright: they can never resolve a check.
+void ChessEngine::generateCheckEvasions(Bitboard checkers, MoveGenType type, MoveList& evasions)
+{
+    Color color = this->currentTurn;
+    int kingSquare = this->kingSquares[color];
+    this->generateSafeKingMoves(this->targetSquares(type), evasions);
+
+    // In double check only the king can move
+    if(popCount(checkers) > 1)
+    {
+        return;
+    }
+
+    Bitboard allowed = checkers | squaresBetween(kingSquare, lowestSquare(checkers));
+    Bitboard pieces = this->board->getOccupancy(color) & ~squareBitboard(kingSquare) &
+                      ~this->pinnedPieces(color, kingSquare);
+    while(pieces)
+    {
+        this->generatePieceMoves(popLowestSquare(pieces), allowed, type, evasions);
+    }
+
+    if(type != QUIETS)
+    {
+        this->generateEnPassantMoves(true, evasions);
+    }
+}
+
+// King steps of the side to move to safe squares among the targets. The
+// safety test sees through the king's own square, so sliders checking along
+// the line of retreat still cover the squares behind it.
+void ChessEngine::generateSafeKingMoves(Bitboard targets, MoveList& moves)
+{
+    Color opponentColor = oppositeColor(this->currentTurn);
+    int kingSquare = this->kingSquares[this->currentTurn];
+    Bitboard kingTargets = kingAttacks(kingSquare) & targets;
+    Bitboard occupiedWithoutKing = this->board->getOccupancy() ^ squareBitboard(kingSquare);
+    while(kingTargets)
+    {
+        int target = popLowestSquare(kingTargets);
+        if(!this->isSquareAttacked(target, opponentColor, occupiedWithoutKing))
+        {
+            int flag = this->board->isOccupied(target) ? PackedMove::CAPTURE : PackedMove::QUIET;
+            moves.push_back(PackedMove(kingSquare, target, flag));
+        }
+    }
+}
+
+// Squares a move of the given type may land on, own pieces excluded
+Bitboard ChessEngine::targetSquares(MoveGenType type) const
+{
+    if(type == CAPTURES)
+    {
+        return this->board->getOccupancy(oppositeColor(this->currentTurn));
+    }
+    if(type == QUIETS)
+    {
+        return ~this->board->getOccupancy();
+    }
+    return ~this->board->getOccupancy(this->currentTurn);
+}
+
+// Checks that the piece on the from square can make the move, then plays it
+// to see that it does not leave the own king attacked
+bool ChessEngine::isLegal(PackedMove move)
+{
+    int from = move.getFrom();
+    int pieceCode = this->board->getPieceCode(from);
+    if(pieceCode == NO_PIECE || pieceCodeColor(pieceCode) != this->currentTurn)
+    {
+        return false;
+    }
+
+    MoveList candidates;
+    if(move.isEnPassant())
+    {
+        this->generateEnPassantMoves(true, candidates);
+    }
+    else if(move.isCastle())
+    {
+        if(pieceCodeType(pieceCode) == KING && !this->isInCheck(this->currentTurn))
+        {
+            this->generateCastlingMoves(from, true, candidates);
+        }
+    }
+    else if(pieceCodeType(pieceCode) == KING)
+    {
+        this->addTargetMoves(from, kingAttacks(from), candidates);
+    }
+    else
+    {
+        this->generatePieceMoves(from, ALL_SQUARES, ALL_MOVES, candidates);
+    }
+    if(find(candidates.begin(), candidates.end(), move) == candidates.end())
+    {
+        return false;
+    }
+
+    // En passant takes a second piece off the board, so it is played out
+    if(move.isEnPassant())
+    {
+        this->makeMoveUnchecked(move);
+        bool legal = !this->isInCheck(oppositeColor(this->currentTurn));
+        this->undoMoveUnchecked();
+        return legal;
+    }
+
+    // Castling was generated as legal; otherwise the same rules as legal
+    // move generation: the king may not step onto an attacked square, and
+    // any other piece must answer a single check and stay on its pin line
+    int to = move.getTo();
+    int kingSquare = this->kingSquares[this->currentTurn];
+    Color opponentColor = oppositeColor(this->currentTurn);
+    Bitboard occupied = this->board->getOccupancy();
+    if(pieceCodeType(pieceCode) == KING)
+    {
+        return move.isCastle() || !this->isSquareAttacked(to, opponentColor, occupied & ~squareBitboard(from));
+    }
+    Bitboard checkers = this->attackersTo(kingSquare, opponentColor, occupied);
+    if(checkers)
+    {
+        Bitboard answers = checkers | squaresBetween(kingSquare, lowestSquare(checkers));
+        if(popCount(checkers) > 1 || !(answers & squareBitboard(to)))
+        {
+            return false;
+        }
+    }
+    return !(this->pinnedPieces(this->currentTurn, kingSquare) & squareBitboard(from)) ||
+           (lineThrough(kingSquare, from) & squareBitboard(to)) != 0;
+}
+
+// Plays the exchange out on bitboards: each side in turn recaptures with its
+// least valuable attacker, and removing a capturer from the occupancy lets
+// a slider behind it attack the square. balance is what the side that just
+// moved stands to keep if the other side stops, less the threshold.
+bool ChessEngine::see(PackedMove move, int threshold) const
+{
+    if(move.isCastle())
+    {
+        return threshold <= 0;
+    }
+    int from = move.getFrom();
+    int to = move.getTo();
+    Bitboard occupied = (this->board->getOccupancy() ^ squareBitboard(from)) | squareBitboard(to);
+    int balance = -threshold;
+    if(move.isEnPassant())
+    {
+        occupied ^= squareBitboard(makeSquareIndex(squareRow(from), squareCol(to)));
+        balance += SEE_VALUES[PAWN];
+    }
+    else if(move.isCapture())
+    {
+        balance += SEE_VALUES[pieceCodeType(this->board->getPieceCode(to))];
+    }
+    int victim = pieceCodeType(this->board->getPieceCode(from));
+    if(move.isPromotion())
+    {
+        victim = move.getPromotionType();
+        balance += SEE_VALUES[victim] - SEE_VALUES[PAWN];
+    }
+    // Losing even with no recapture, or winning even if the piece is lost
+    if(balance < 0)
+    {
+        return false;
+    }
+    balance -= SEE_VALUES[victim];
+    if(balance >= 0)
+    {
+        return true;
+    }
+
+    Bitboard pieces[6];
+    for(int type = PAWN; type <= KING; type++)
+    {
+        pieces[type] = this->board->getPieces(WHITE, static_cast<PieceType>(type)) |
+                       this->board->getPieces(BLACK, static_cast<PieceType>(type));
+    }
+    Bitboard diagonals = pieces[BISHOP] | pieces[QUEEN];
+    Bitboard straights = pieces[ROOK] | pieces[QUEEN];
+    Bitboard attackers = (this->attackersTo(to, WHITE, occupied) | this->attackersTo(to, BLACK, occupied)) & occupied;
+
+    Color color = oppositeColor(this->currentTurn);
+    while(true)
+    {
+        Bitboard ownAttackers = attackers & this->board->getOccupancy(color);
+        if(!ownAttackers)
+        {
+            break;
+        }
+        int attacker = PAWN;
+        while(!(ownAttackers & pieces[attacker]))
+        {
+            attacker++;
+        }
+        occupied ^= squareBitboard(lowestSquare(ownAttackers & pieces[attacker]));
+        if(attacker == PAWN || attacker == BISHOP || attacker == QUEEN)
+        {
+            attackers |= bishopAttacks(to, occupied) & diagonals;
+        }
+        if(attacker == ROOK || attacker == QUEEN)
+        {
+            attackers |= rookAttacks(to, occupied) & straights;
+        }
+        attackers &= occupied;
+        color = oppositeColor(color);
+
+        // Negamax step; the extra -1 breaks ties toward the side that stops
+        balance = -balance - 1 - SEE_VALUES[attacker];
+        if(balance >= 0)
+        {
+            // A king may not recapture into an attacked square
+            if(attacker == KING && (attackers & this->board->getOccupancy(color)))
+            {
+                color = oppositeColor(color);
+            }
+            break;
+        }
+    }
+    // The side left to move is the one that ran out of good recaptures
+    return color != this->currentTurn;
+}
+
+const GameStatus& ChessEngine::evaluateStatus()
+{
+    if(!this->statusValid)
+    {
+        LegalMoveCache::Key key = this->moveCacheKey();
+        if(!this->moveCache.probe(this->hash, key, this->status.legalMoves, this->status.inCheck))
+        {
+            this->status.legalMoves.clear();
+            this->generateLegalMoves(this->status.legalMoves);
+            this->status.inCheck = this->isInCheck(this->currentTurn);
+            this->moveCache.store(this->hash, key, this->status.legalMoves, this->status.inCheck);
+        }
+        this->status.checkmate = this->status.legalMoves.empty() && this->status.inCheck;
+        this->status.stalemate = this->status.legalMoves.empty() && !this->status.inCheck;
+        this->statusValid = true;
+    }
+    return this->status;
+}
+
+LegalMoveCache::Key ChessEngine::moveCacheKey() const
+{
+    LegalMoveCache::Key key;
+    for(int code = 0; code < 12; code++)
+    {
+        key.pieces[code] = this->board->getPieces(pieceCodeColor(code), pieceCodeType(code));
+    }
+    key.sideToMove = this->currentTurn;
+    key.castlingRights = this->castlingRights;
+    key.enPassantSquare = this->enPassantSquare;
+    return key;
+}
+
+bool ChessEngine::isCheckmate()
+{
+    return this->evaluateStatus().checkmate;
 }
     
-void ChessEngine::undoMoveTesting()
+bool ChessEngine::isStalemate()
 {
-    if(this->moveLog.empty()) 
+    return this->evaluateStatus().stalemate;
+}
+    
+vector<Move> ChessEngine::getAllPossibleMoves()
+{
+    MoveList possibleMoves;
+    this->generatePossibleMoves(possibleMoves);
+    vector<Move> moves;
+    this->appendMoves(possibleMoves, moves);
+    return moves;
+}
+
+void ChessEngine::generatePossibleMoves(MoveList& possibleMoves)
+{
+    // Only visit squares holding a piece of the side to move
+    Bitboard ownPieces = this->board->getOccupancy(this->currentTurn);
+    while(ownPieces)
+    {
+        int square = popLowestSquare(ownPieces);
+        if(pieceCodeType(this->board->getPieceCode(square)) == KING)
+        {
+            this->generateKingMoves(square, possibleMoves);
+        }
+        else
+        {
+            this->generatePieceMoves(square, ALL_SQUARES, ALL_MOVES, possibleMoves);
+        }
+    }
+    this->generateEnPassantMoves(false, possibleMoves);
+} 
+
+void ChessEngine::getPawnMoves(const shared_ptr<Square> startSquare, vector<Move>& possibleMoves)
+{
+    int square = makeSquareIndex(startSquare->getRow(), startSquare->getCol());
+    MoveList moves;
+    this->generatePawnMoves(square, ALL_SQUARES, ALL_MOVES, moves);
+
+    // En passant is generated for all pawns at once; keep this pawn's
+    MoveList enPassantMoves;
+    this->generateEnPassantMoves(false, enPassantMoves);
+    for(PackedMove move : enPassantMoves)
+    {
+        if(move.getFrom() == square)
+        {
+            moves.push_back(move);
+        }
+    }
+    this->appendMoves(moves, possibleMoves);
+}
+
+void ChessEngine::getRookMoves(const shared_ptr<Square> startSquare, vector<Move>& possibleMoves)
+{
+    MoveList moves;
+    this->generateRookMoves(makeSquareIndex(startSquare->getRow(), startSquare->getCol()), ALL_SQUARES, moves);
+    this->appendMoves(moves, possibleMoves);
+}
+
+void ChessEngine::getBishopMoves(const shared_ptr<Square> startSquare, vector<Move>& possibleMoves)
+{
+    MoveList moves;
+    this->generateBishopMoves(makeSquareIndex(startSquare->getRow(), startSquare->getCol()), ALL_SQUARES, moves);
+    this->appendMoves(moves, possibleMoves);
+}
+
+void ChessEngine::getQueenMoves(const shared_ptr<Square> startSquare, vector<Move>& possibleMoves)
+{
+    MoveList moves;
+    this->generateQueenMoves(makeSquareIndex(startSquare->getRow(), startSquare->getCol()), ALL_SQUARES, moves);
+    this->appendMoves(moves, possibleMoves);
+}
+
+void ChessEngine::getKnightMoves(const shared_ptr<Square> startSquare, vector<Move>& possibleMoves)
+{
+    MoveList moves;
+    this->generateKnightMoves(makeSquareIndex(startSquare->getRow(), startSquare->getCol()), ALL_SQUARES, moves);
+    this->appendMoves(moves, possibleMoves);
+}
+
+void ChessEngine::getKingMoves(const shared_ptr<Square> startSquare, vector<Move>& possibleMoves)
+{
+    MoveList moves;
+    this->generateKingMoves(makeSquareIndex(startSquare->getRow(), startSquare->getCol()), moves);
+    this->appendMoves(moves, possibleMoves);
+}
+
+Move ChessEngine::toMove(PackedMove packedMove) const
+{
+    int from = packedMove.getFrom();
+    int to = packedMove.getTo();
+    shared_ptr<Square> startSquare = this->board->getSquare(squareRow(from), squareCol(from));
+    shared_ptr<Square> endSquare = this->board->getSquare(squareRow(to), squareCol(to));
+    shared_ptr<Piece> pieceCaptured = endSquare->getPiece();
+    if(packedMove.isEnPassant())
+    {
+        pieceCaptured = this->board->getSquare(squareRow(from), squareCol(to))->getPiece();
+    }
+    Move move(startSquare, endSquare, startSquare->getPiece(), pieceCaptured);
+    this->setMoveFlags(move, packedMove, pieceCodeColor(this->board->getPieceCode(from)));
+    return move;
+}
+
+PackedMove ChessEngine::toPackedMove(const Move& move) const
+{
+    int from = makeSquareIndex(move.getStartSquare()->getRow(), move.getStartSquare()->getCol());
+    int to = makeSquareIndex(move.getEndSquare()->getRow(), move.getEndSquare()->getCol());
+    if(move.getIsKingSideCastle())
+    {
+        return PackedMove(from, to, PackedMove::KING_CASTLE);
+    }
+    if(move.getIsQueenSideCastle())
     {
+        return PackedMove(from, to, PackedMove::QUEEN_CASTLE);
+    }
+    if(move.getIsEnpassantMove())
+    {
+        return PackedMove(from, to, PackedMove::EN_PASSANT);
+    }
+    bool capture = this->board->isOccupied(to);
+    if(move.getIsPawnPromotionMove())
+    {
+        if(move.getPawnPromotionPiece() == nullptr)
+        {
+            throw invalid_argument("Pawn promotion piece must be set before calling makeMove");
+        }
+        PieceType promotionType = pieceCodeType(Board::pieceCodeOf(*move.getPawnPromotionPiece()));
+        int flags = (capture ? PackedMove::KNIGHT_PROMOTION_CAPTURE : PackedMove::KNIGHT_PROMOTION) + (promotionType - KNIGHT);
+        return PackedMove(from, to, flags);
+    }
+    if(pieceCodeType(this->board->getPieceCode(from)) == PAWN && abs(squareRow(to) - squareRow(from)) == 2)
+    {
+        return PackedMove(from, to, PackedMove::DOUBLE_PAWN_PUSH);
+    }
+    return PackedMove(from, to, capture ? PackedMove::CAPTURE : PackedMove::QUIET);
+}
+
+void ChessEngine::setMoveFlags(Move& move, PackedMove packedMove, Color color) const
+{
+    int from = packedMove.getFrom();
+    int to = packedMove.getTo();
+    if(packedMove.isEnPassant())
+    {
+        move.setEnpassant();
+        move.setEnPassantCapturingSquare(this->board->getSquare(squareRow(from), squareCol(to)));
+    }
+    if(packedMove.getFlags() == PackedMove::KING_CASTLE)
+    {
+        move.setKingSideCastle();
+    }
+    if(packedMove.getFlags() == PackedMove::QUEEN_CASTLE)
+    {
+        move.setQueenSideCastle();
+    }
+    if(packedMove.isPromotion())
+    {
+        move.setPawnPromotion();
+        move.setPawnPromotionPiece(Board::createPiece(makePieceCode(color, packedMove.getPromotionType())));
+    }
+}
+
+void ChessEngine::appendMoves(const MoveList& packedMoves, vector<Move>& moves) const
+{
+    moves.reserve(moves.size() + packedMoves.size());
+    for(PackedMove packedMove : packedMoves)
+    {
+        moves.push_back(this->toMove(packedMove));
+    }
+}
+    
+// Generates the non-king moves of the piece on the square, limited to the allowed targets
+void ChessEngine::generatePieceMoves(int square, Bitboard allowed, MoveGenType type, MoveList& possibleMoves)
+{
+    PieceType pieceType = pieceCodeType(this->board->getPieceCode(square));
+    if(pieceType == PAWN)
+    {
+        // Pawns sort their quiet promotions in with the captures themselves
+        this->generatePawnMoves(square, allowed, type, possibleMoves);
         return;
     }
-    Move lastMove = this->moveLog.back();
-    this->moveLog.pop_back();
-    shared_ptr<Piece> pieceMoved = lastMove.getPieceMoved();
-    shared_ptr<Piece> pieceCaptured = lastMove.getPieceCaptured();
-    shared_ptr<Square> start = lastMove.getStartSquare();
-    shared_ptr<Square> end = lastMove.getEndSquare();
-    if(lastMove.getIsEnpassantMove()) 
-    {
-        start->setPiece(pieceMoved);
-        end->removePiece();
-        shared_ptr<Square> epCaptureSquare = lastMove.getEnPassantCapturingSquare();
-        if(epCaptureSquare) 
+    if(type == CAPTURES)
+    {
+        allowed &= this->board->getOccupancy();
+    }
+    else if(type == QUIETS)
+    {
+        allowed &= ~this->board->getOccupancy();
+    }
+    switch(pieceType)
+    {
+        case ROOK:
+            this->generateRookMoves(square, allowed, possibleMoves);
+            break;
+        case BISHOP:
+            this->generateBishopMoves(square, allowed, possibleMoves);
+            break;
+        case QUEEN:
+            this->generateQueenMoves(square, allowed, possibleMoves);
+            break;
+        case KNIGHT:
+            this->generateKnightMoves(square, allowed, possibleMoves);
+            break;
+        default:
+            break;
+    }
+}
+
+void ChessEngine::generatePawnMoves(int square, Bitboard allowed, MoveGenType type, MoveList& possibleMoves)
+{
+    int row = squareRow(square);
+    int col = squareCol(square);
+    Color myColor = pieceCodeColor(this->board->getPieceCode(square));
+    int direction = (myColor == WHITE) ? -1 : 1;
+    int startRow = (myColor == WHITE) ? 6 : 1;
+    int newRow = row + direction;
+    if(newRow < 0 || newRow > 7)
+    {
+        return;
+    }
+
+    // Forward moves, two squares from the starting row if both are empty.
+    // A push to the last row is a promotion and belongs with the captures.
+    int target = makeSquareIndex(newRow, col);
+    bool promotion = newRow == 0 || newRow == 7;
+    bool pushWanted = promotion ? type != QUIETS : type != CAPTURES;
+    if(!this->board->isOccupied(target) && pushWanted)
+    {
+        if(allowed & squareBitboard(target))
+        {
+            this->addPawnMoves(square, target, false, possibleMoves);
+        }
+        int twoSquareTarget = makeSquareIndex(row + 2 * direction, col);
+        if(row == startRow && !this->board->isOccupied(twoSquareTarget) && (allowed & squareBitboard(twoSquareTarget)))
+        {
+            possibleMoves.push_back(PackedMove(square, twoSquareTarget, PackedMove::DOUBLE_PAWN_PUSH));
+        }
+    }
+
+    // Diagonal captures; en passant is generated separately
+    if(type == QUIETS)
+    {
+        return;
+    }
+    Bitboard captures = pawnAttacks(myColor, square) & this->board->getOccupancy(oppositeColor(myColor)) & allowed;
+    while(captures)
+    {
+        this->addPawnMoves(square, popLowestSquare(captures), true, possibleMoves);
+    }
+}
+
+// En passant captures for the side to move. With legalOnly set, each capture is
+// replayed on the occupancy, which also catches the pawn pair leaving a rank
+// and exposing the king to a rook or queen.
+void ChessEngine::generateEnPassantMoves(bool legalOnly, MoveList& possibleMoves)
+{
+    if(this->enPassantSquare == NO_SQUARE)
+    {
+        return;
+    }
+    Color color = this->currentTurn;
+    Color opponentColor = oppositeColor(color);
+    int capturedSquare = this->enPassantSquare + (color == WHITE ? 8 : -8);
+    Bitboard pawns = pawnAttacks(opponentColor, this->enPassantSquare) & this->board->getPieces(color, PAWN);
+    while(pawns)
+    {
+        int from = popLowestSquare(pawns);
+        if(legalOnly)
         {
-            epCaptureSquare->setPiece(pieceCaptured);
+            int kingSquare = this->kingSquares[color];
+            Bitboard occupied = (this->board->getOccupancy() ^ squareBitboard(from) ^ squareBitboard(capturedSquare)) |
+                                squareBitboard(this->enPassantSquare);
+            if(this->attackersTo(kingSquare, opponentColor, occupied) & ~squareBitboard(capturedSquare))
+            {
+                continue;
+            }
         }
-        pieceMoved->setMoved(lastMove.getHadPieceBeenMoved());
+        possibleMoves.push_back(PackedMove(from, this->enPassantSquare, PackedMove::EN_PASSANT));
+    }
+}
+
+// Adds a pawn move, expanded into the four promotions on the last row
+void ChessEngine::addPawnMoves(int from, int to, bool capture, MoveList& possibleMoves)
+{
+    int row = squareRow(to);
+    if(row == 0 || row == 7)
+    {
+        int promotion = capture ? PackedMove::KNIGHT_PROMOTION_CAPTURE : PackedMove::KNIGHT_PROMOTION;
+        possibleMoves.push_back(PackedMove(from, to, promotion + (QUEEN - KNIGHT)));
+        possibleMoves.push_back(PackedMove(from, to, promotion + (ROOK - KNIGHT)));
+        possibleMoves.push_back(PackedMove(from, to, promotion + (BISHOP - KNIGHT)));
+        possibleMoves.push_back(PackedMove(from, to, promotion));
+    }
+    else
+    {
+        possibleMoves.push_back(PackedMove(from, to, capture ? PackedMove::CAPTURE : PackedMove::QUIET));
+    }
+}
+
+void ChessEngine::generateRookMoves(int square, Bitboard allowed, MoveList& possibleMoves)
+{
+    this->addTargetMoves(square, rookAttacks(square, this->board->getOccupancy()) & allowed, possibleMoves);
+}
+    
+void ChessEngine::generateBishopMoves(int square, Bitboard allowed, MoveList& possibleMoves)
+{
+    this->addTargetMoves(square, bishopAttacks(square, this->board->getOccupancy()) & allowed, possibleMoves);
+}
+    
+void ChessEngine::generateQueenMoves(int square, Bitboard allowed, MoveList& possibleMoves)
+{
+    this->addTargetMoves(square, queenAttacks(square, this->board->getOccupancy()) & allowed, possibleMoves);
+}
+
+// Quiet moves to the empty targets and captures of enemy pieces; own pieces are skipped
+void ChessEngine::addTargetMoves(int from, Bitboard targets, MoveList& possibleMoves)
+{
+    Color myColor = pieceCodeColor(this->board->getPieceCode(from));
+    targets &= ~this->board->getOccupancy(myColor);
+    Bitboard captures = targets & this->board->getOccupancy(oppositeColor(myColor));
+    Bitboard quiets = targets & ~captures;
+    while(captures)
+    {
+        possibleMoves.push_back(PackedMove(from, popLowestSquare(captures), PackedMove::CAPTURE));
+    }
+    while(quiets)
+    {
+        possibleMoves.push_back(PackedMove(from, popLowestSquare(quiets), PackedMove::QUIET));
+    }
+}
+    
+void ChessEngine::generateKnightMoves(int square, Bitboard allowed, MoveList& possibleMoves)
+{
+    this->addTargetMoves(square, knightAttacks(square) & allowed, possibleMoves);
+}
+    
+void ChessEngine::generateKingMoves(int square, MoveList& possibleMoves)
+{
+    this->addTargetMoves(square, kingAttacks(square), possibleMoves);
+    this->generateCastlingMoves(square, false, possibleMoves);
+}
+
+// Castling rights imply the king and the rook are still on their starting squares.
+// With legalOnly set, the king may not be in check or pass through or land on an attacked square.
+void ChessEngine::generateCastlingMoves(int square, bool legalOnly, MoveList& possibleMoves)
+{
+    int row = squareRow(square);
+    Color myColor = pieceCodeColor(this->board->getPieceCode(square));
+    Color opponentColor = oppositeColor(myColor);
+    int kingSideRight = (myColor == WHITE) ? WHITE_KINGSIDE : BLACK_KINGSIDE;
+    int queenSideRight = (myColor == WHITE) ? WHITE_QUEENSIDE : BLACK_QUEENSIDE;
+
+    if((this->castlingRights & kingSideRight) &&
+        !this->board->isOccupied(row, 5) && !this->board->isOccupied(row, 6) &&
+        (!legalOnly || (!this->isSquareUnderAttack(square + 1, opponentColor) &&
+                        !this->isSquareUnderAttack(square + 2, opponentColor)))) 
+    {
+        possibleMoves.push_back(PackedMove(square, square + 2, PackedMove::KING_CASTLE));
+    }
+
+    if((this->castlingRights & queenSideRight) &&
+        !this->board->isOccupied(row, 1) && !this->board->isOccupied(row, 2) && !this->board->isOccupied(row, 3) &&
+        (!legalOnly || (!this->isSquareUnderAttack(square - 1, opponentColor) &&
+                        !this->isSquareUnderAttack(square - 2, opponentColor)))) 
+    {
+        possibleMoves.push_back(PackedMove(square, square - 2, PackedMove::QUEEN_CASTLE));
+    }
+}
+    
+void ChessEngine::resign()
+{
+    this->gameResult->setResult(GameResult::resignationBy(this->currentTurn),
+        colorName(this->currentTurn) + " resigned");
+}
+    
+bool ChessEngine::requestDraw()
+{
+    if(this->drawRequestedBy == "")
+    {
+        this->drawRequestedBy = colorName(this->currentTurn);
+        return false;
+    }
+    else if(this->drawRequestedBy == colorName(this->currentTurn))
+    {
+        return false;
+    }
+    else
+    {
+        this->gameResult->setResult(GameResult::ResultType::DRAW, "Draw agreed by both players");
+        this->drawRequestedBy = "";
+        return true;
+    }
+}
+    
+void ChessEngine::acceptDraw()
+{
+    if(this->drawRequestedBy == "") 
+    {
+        throw std::runtime_error("No draw request to accept");
+    }
+    if(this->drawRequestedBy == colorName(this->currentTurn)) {
+        throw std::runtime_error("You cannot accept your own draw request");
+    }
+
+    this->gameResult->setResult(GameResult::ResultType::DRAW, "Draw agreed by both players");
+    this->drawRequestedBy = "";
+}
+    
+void ChessEngine::declineDraw()
+{   
+    if(this->drawRequestedBy == "") 
+    {
+        throw std::runtime_error("No draw request to decline");
+    }
+    this->drawRequestedBy = "";
+}
+
+
+void ChessEngine::makeMoveUnchecked(PackedMove move)
+{
+    int from = move.getFrom();
+    int to = move.getTo();
+    const ZobristKeys& keys = zobristKeys;
+
+    MoveRecord record;
+    record.move = move;
+    record.pieceMoved = this->board->getPieceCode(from);
+    record.pieceCaptured = NO_PIECE;
+    record.castlingRights = this->castlingRights;
+    record.enPassantSquare = this->enPassantSquare;
+    record.halfmoveClock = this->halfmoveClock;
+    record.hash = this->hash;
+    record.scores = this->scores;
+    if(!this->accumulators.empty())
+    {
+        this->accumulators.push_back(this->accumulators.back());
+    }
+    Color color = pieceCodeColor(record.pieceMoved);
+
+    // Take out the old castling and en passant keys before the pawns move
+    this->hash ^= keys.castling[this->castlingRights] ^ this->enPassantKey();
+
+    if(move.isEnPassant()) 
+    {
+        // The captured pawn stands beside the moving pawn, not on the target square
+        int captureSquare = makeSquareIndex(squareRow(from), squareCol(to));
+        record.pieceCaptured = this->board->getPieceCode(captureSquare);
+        this->board->removePiece(captureSquare);
+        this->hash ^= keys.pieces[record.pieceCaptured][captureSquare];
+        this->removePieceScore(record.pieceCaptured, captureSquare);
+    }
+    else if(move.isCapture())
+    {
+        record.pieceCaptured = this->board->getPieceCode(to);
+        this->board->removePiece(to);
+        this->hash ^= keys.pieces[record.pieceCaptured][to];
+        this->removePieceScore(record.pieceCaptured, to);
+    }
+
+    int pieceLanded = record.pieceMoved;
+    if(move.isPromotion()) 
+    {
+        pieceLanded = makePieceCode(color, move.getPromotionType());
+        this->board->removePiece(from);
+        this->board->addPiece(to, pieceLanded);
+    }
+    else
+    {
+        this->board->movePiece(from, to);
+    }
+    this->hash ^= keys.pieces[record.pieceMoved][from] ^ keys.pieces[pieceLanded][to];
+    this->removePieceScore(record.pieceMoved, from);
+    this->addPieceScore(pieceLanded, to);
+
+    // Castling - move the rook as well
+    int rook = makePieceCode(color, ROOK);
+    if(move.getFlags() == PackedMove::KING_CASTLE) 
+    {
+        this->board->movePiece(to + 1, to - 1);
+        this->hash ^= keys.pieces[rook][to + 1] ^ keys.pieces[rook][to - 1];
+        this->removePieceScore(rook, to + 1);
+        this->addPieceScore(rook, to - 1);
+    }
+    if(move.getFlags() == PackedMove::QUEEN_CASTLE) 
+    {
+        this->board->movePiece(to - 2, to + 1);
+        this->hash ^= keys.pieces[rook][to - 2] ^ keys.pieces[rook][to + 1];
+        this->removePieceScore(rook, to - 2);
+        this->addPieceScore(rook, to + 1);
+    }
+
+    if(pieceCodeType(record.pieceMoved) == KING)
+    {
+        this->kingSquares[color] = to;
+    }
+
+    this->castlingRights &= castlingMask(from) & castlingMask(to);
+    this->enPassantSquare = move.isDoublePawnPush() ? (from + to) / 2 : NO_SQUARE;
+    bool irreversible = pieceCodeType(record.pieceMoved) == PAWN || record.pieceCaptured != NO_PIECE;
+    this->halfmoveClock = irreversible ? 0 : this->halfmoveClock + 1;
+    if(color == BLACK)
+    {
+        this->fullmoveNumber++;
+    }
+    this->currentTurn = oppositeColor(this->currentTurn);
+    this->hash ^= keys.castling[this->castlingRights] ^ keys.side ^ this->enPassantKey();
+    this->moveLog.push_back(record);
+    this->statusValid = false;
+    assert(this->hash == this->computeHash());
+    assert(this->scores == this->computeScores());
+    assert(this->accumulatorInSync());
+}
+    
+void ChessEngine::undoMoveUnchecked()
+{
+    if(this->moveLog.empty()) 
+    {
         return;
     }
-    if(lastMove.getIsKingSideCastle() || lastMove.getIsQueenSideCastle()) 
+    MoveRecord lastMove = this->moveLog.back();
+    this->moveLog.pop_back();
+    int from = lastMove.move.getFrom();
+    int to = lastMove.move.getTo();
+
+    if(lastMove.move.getFlags() == PackedMove::KING_CASTLE) 
+    {
+        this->board->movePiece(to - 1, to + 1);
+    }
+    if(lastMove.move.getFlags() == PackedMove::QUEEN_CASTLE) 
     {
-        int row = start->getRow();
-        start->setPiece(pieceMoved);
-        end->removePiece();
-        pieceMoved->setMoved(lastMove.getHadPieceBeenMoved());
+        this->board->movePiece(to + 1, to - 2);
+    }
 
-        if(lastMove.getIsKingSideCastle()) 
+    if(lastMove.move.isPromotion()) 
+    {
+        this->board->removePiece(to);
+        this->board->addPiece(from, lastMove.pieceMoved);
+    }
+    else
+    {
+        this->board->movePiece(to, from);
+    }
+
+    if(lastMove.pieceCaptured != NO_PIECE) 
+    {
+        int captureSquare = lastMove.move.isEnPassant() ? makeSquareIndex(squareRow(from), squareCol(to)) : to;
+        this->board->addPiece(captureSquare, lastMove.pieceCaptured);
+    }
+
+    if(pieceCodeType(lastMove.pieceMoved) == KING)
+    {
+        this->kingSquares[pieceCodeColor(lastMove.pieceMoved)] = from;
+    }
+
+    this->castlingRights = lastMove.castlingRights;
+    this->enPassantSquare = lastMove.enPassantSquare;
+    this->halfmoveClock = lastMove.halfmoveClock;
+    if(pieceCodeColor(lastMove.pieceMoved) == BLACK)
+    {
+        this->fullmoveNumber--;
+    }
+    this->currentTurn = oppositeColor(this->currentTurn);
+    this->hash = lastMove.hash;
+    this->scores = lastMove.scores;
+    if(!this->accumulators.empty())
+    {
+        this->accumulators.pop_back();
+    }
+    this->statusValid = false;
+    assert(this->hash == this->computeHash());
+    assert(this->scores == this->computeScores());
+}
+
+uint64_t ChessEngine::getHash() const
+{
+    return this->hash;
+}
+
+int ChessEngine::getLastMovedPiece() const
+{
+    return this->moveLog.empty() ? NO_PIECE : this->moveLog.back().pieceMoved;
+}
+
+int ChessEngine::getLastMoveTarget() const
+{
+    return this->moveLog.empty() ? NO_SQUARE : this->moveLog.back().move.getTo();
+}
+
+// A position is repeated when an earlier one with the same side to move has
+// the same hash; nothing before the last capture or pawn move can match
+bool ChessEngine::isRepetition() const
+{
+    int limit = min(this->halfmoveClock, static_cast<int>(this->moveLog.size()));
+    for(int back = 2; back <= limit; back += 2)
+    {
+        if(this->moveLog[this->moveLog.size() - back].hash == this->hash)
         {
-            shared_ptr<Square> rookEnd = this->board->getSquare(row, 5);
-            shared_ptr<Square> rookStart = this->board->getSquare(row, 7);
-            shared_ptr<Piece> rook = rookEnd->getPiece();
-            rookStart->setPiece(rook);
-            rookEnd->removePiece();
-            rook->setMoved(false); 
+            return true;
         }
-        else 
+    }
+    return false;
+}
+
+// Recomputes the Zobrist key from scratch; make/undo keep it incrementally
+uint64_t ChessEngine::computeHash() const
+{
+    const ZobristKeys& keys = zobristKeys;
+    uint64_t key = keys.castling[this->castlingRights] ^ this->enPassantKey();
+    if(this->currentTurn == BLACK)
+    {
+        key ^= keys.side;
+    }
+    Bitboard occupied = this->board->getOccupancy();
+    while(occupied)
+    {
+        int square = popLowestSquare(occupied);
+        key ^= keys.pieces[this->board->getPieceCode(square)][square];
+    }
+    return key;
+}
+
+int ChessEngine::evaluate() const
+{
+    if(this->network)
+    {
+        if(this->accumulators.empty())
         {
-            shared_ptr<Square> rookEnd = this->board->getSquare(row, 3);
-            shared_ptr<Square> rookStart = this->board->getSquare(row, 0);
-            shared_ptr<Piece> rook = rookEnd->getPiece();
-            rookStart->setPiece(rook);
-            rookEnd->removePiece();
-            rook->setMoved(false);
+            this->accumulators.resize(1);
+            this->network->refresh(*this->board, this->accumulators.back());
         }
-        return;   
+        return this->network->evaluate(this->accumulators.back(), this->currentTurn);
+    }
+    int phase = this->scores.phase < MAX_PHASE ? this->scores.phase : MAX_PHASE;
+    int score = (this->scores.middlegame * phase + this->scores.endgame * (MAX_PHASE - phase)) / MAX_PHASE;
+    return this->currentTurn == WHITE ? score : -score;
+}
+
+// Sums the evaluation terms from scratch; make/undo keep them incrementally
+EvalScores ChessEngine::computeScores() const
+{
+    EvalScores total = {0, 0, 0};
+    Bitboard occupied = this->board->getOccupancy();
+    while(occupied)
+    {
+        int square = popLowestSquare(occupied);
+        int code = this->board->getPieceCode(square);
+        total.middlegame += evalTables.middlegame[code][square];
+        total.endgame += evalTables.endgame[code][square];
+        total.phase += evalTables.phase[code];
+    }
+    return total;
+}
+
+void ChessEngine::addPieceScore(int code, int square)
+{
+    this->scores.middlegame += evalTables.middlegame[code][square];
+    this->scores.endgame += evalTables.endgame[code][square];
+    this->scores.phase += evalTables.phase[code];
+    if(!this->accumulators.empty())
+    {
+        this->network->addPiece(this->accumulators.back(), code, square);
+    }
+}
+
+void ChessEngine::removePieceScore(int code, int square)
+{
+    this->scores.middlegame -= evalTables.middlegame[code][square];
+    this->scores.endgame -= evalTables.endgame[code][square];
+    this->scores.phase -= evalTables.phase[code];
+    if(!this->accumulators.empty())
+    {
+        this->network->removePiece(this->accumulators.back(), code, square);
+    }
+}
+
+// Replays the game from its first position so every position in the log
+// gets its accumulator
+void ChessEngine::setNetwork(shared_ptr<const NnueNetwork> network)
+{
+    vector<PackedMove> moves;
+    for(const MoveRecord& record : this->moveLog)
+    {
+        moves.push_back(record.move);
+    }
+    this->network = nullptr;
+    while(!this->moveLog.empty())
+    {
+        this->undoMoveUnchecked();
+    }
+    this->network = network;
+    this->refreshAccumulators();
+    for(PackedMove move : moves)
+    {
+        this->makeMoveUnchecked(move);
+    }
+}
+
+// Starts the accumulator stack from the current position, with an empty log
+void ChessEngine::refreshAccumulators()
+{
+    this->accumulators.clear();
+    if(this->network)
+    {
+        this->accumulators.resize(1);
+        this->network->refresh(*this->board, this->accumulators.back());
+    }
+}
+
+bool ChessEngine::accumulatorInSync() const
+{
+    if(this->accumulators.empty())
+    {
+        return true;
+    }
+    NnueAccumulator expected;
+    this->network->refresh(*this->board, expected);
+    return memcmp(&expected, &this->accumulators.back(), sizeof(expected)) == 0;
+}
+
+// The en passant file only counts when a pawn of the side to move can
+// actually capture, so transpositions that differ by a useless double push
+// still hash the same
+uint64_t ChessEngine::enPassantKey() const
+{
+    if(this->enPassantSquare == NO_SQUARE)
+    {
+        return 0;
+    }
+    Color opponentColor = oppositeColor(this->currentTurn);
+    if(pawnAttacks(opponentColor, this->enPassantSquare) & this->board->getPieces(this->currentTurn, PAWN))
+    {
+        return zobristKeys.enPassantFile[squareCol(this->enPassantSquare)];
     }
-    start->setPiece(pieceMoved);
-    end->setPiece(pieceCaptured);   
-    pieceMoved->setMoved(lastMove.getHadPieceBeenMoved());
+    return 0;
 }
 
 
@@ -2,52 +2,181 @@
 #define CHESSENGINE_H
 #include "Board.h"
 #include "Move.h"
+#include "MoveList.h"
+#include "LegalMoveCache.h"
 #include "GameResult.h"
+#include "Evaluation.h"
+#include "Nnue.h"
+#include <cstdint>
 #include <vector>
 
+class PerftTable;
+
+// Check state and legal moves of a position, worked out in a single pass
+struct GameStatus
+{
+    bool inCheck;
+    bool checkmate;
+    bool stalemate;
+    MoveList legalMoves;
+};
+
 class ChessEngine
 {
+    // Move log entry: the packed move plus what undoing it needs
+    struct MoveRecord
+    {
+        PackedMove move;
+        int pieceMoved;
+        int pieceCaptured;
+        int castlingRights;
+        int enPassantSquare;
+        int halfmoveClock;
+        uint64_t hash;
+        EvalScores scores;
+    };
+
     std::shared_ptr<Board> board;
-    std::string currentTurn;
-    std::vector<Move> moveLog;
+    Color currentTurn;
+    std::vector<MoveRecord> moveLog;
+    int castlingRights;
+    int enPassantSquare;
+    int kingSquares[2];
+    int halfmoveClock;
+    int fullmoveNumber;
+    uint64_t hash;
+    EvalScores scores;
+    // With a network set, one accumulator per position in the move log
+    // plus the current one. setPosition leaves the stack empty and
+    // evaluate() refreshes the current position's on demand; make/undo
+    // leave an empty stack alone.
+    std::shared_ptr<const NnueNetwork> network;
+    mutable std::vector<NnueAccumulator> accumulators;
+    GameStatus status;
+    bool statusValid;
+    LegalMoveCache moveCache;
     std::string drawRequestedBy;
     std::shared_ptr<GameResult> gameResult;
 
     public:
+    // Which moves a generation pass emits; captures include every promotion
+    enum MoveGenType
+    {
+        CAPTURES,
+        QUIETS,
+        ALL_MOVES
+    };
+
     ChessEngine();
+    ChessEngine(const ChessEngine& other);
+    ChessEngine& operator=(const ChessEngine& other);
     std::shared_ptr<Board> getBoard() const;
     std::vector<Move> getMoveLog() const;
-    std::string getCurrentTurn() const;
+    Color getCurrentTurn() const;
+    std::string getCurrentTurnName() const;
     std::shared_ptr<GameResult> getGameResult() const;
     std::string getDrawRequestedBy() const;
     void clearDrawRequest();
-    void setCurrentTurn(const std::string& currentTurn);
+    // Changing the turn by hand also clears the en passant square
+    void setCurrentTurn(Color currentTurn);
+    // Both throw std::invalid_argument unless the move is legal here
     void makeMove(Move& move);
+    void makeMove(PackedMove move);
     void undoMove();
-    std::shared_ptr<Square> findKing(const std::string& color) const;
-    bool isSquareUnderAttack(int row, int col, const std::string& byColor);
-    bool isInCheck(const std::string& color);
+    // Fast path for searches: the move must be legal here, and the Square
+    // view is left behind until the next makeMove, undoMove or setup
+    void makeMoveUnchecked(PackedMove move);
+    void undoMoveUnchecked();
+    // Piece code and target square of the last move; NO_PIECE when none
+    int getLastMovedPiece() const;
+    int getLastMoveTarget() const;
+    // Whether the position occurred before with the same side to move
+    bool isRepetition() const;
+    std::shared_ptr<Square> findKing(Color color) const;
+    int getKingSquare(Color color) const;
+    uint64_t getHash() const;
+    // Static evaluation in centipawns for the side to move, read from the
+    // scores make/undo keep up to date: the network's when one is set,
+    // else the material and piece-square tables
+    int evaluate() const;
+    // Shared between copies of the engine; null goes back to the tables
+    void setNetwork(std::shared_ptr<const NnueNetwork> network);
+    void loadFEN(const std::string& fen);
+    int getHalfmoveClock() const;
+    int getFullmoveNumber() const;
+    // Snapshot of the current position; setting one clears the move log and,
+    // like makeMoveUnchecked, leaves the Square view behind until the next
+    // makeMove, undoMove or setup
+    Position getPosition() const;
+    void setPosition(const Position& position);
+    uint64_t perft(int depth);
+    uint64_t perft(int depth, PerftTable& table);
+    bool isSquareUnderAttack(int row, int col, Color byColor) const;
+    bool isSquareUnderAttack(int square, Color byColor) const;
+    bool isInCheck(Color color) const;
     std::vector<Move> getAllLegalMoves();
+    void generateLegalMoves(MoveList& legalMoves, MoveGenType type = ALL_MOVES);
+    void generateCaptures(MoveList& captures);
+    void generateEvasions(MoveList& evasions);
+    // Whether a move, e.g. one remembered from another position, is legal here
+    bool isLegal(PackedMove move);
+    // Static exchange evaluation: whether the move wins at least threshold
+    // centipawns once the captures it starts on its target square are
+    // resolved, without touching the board. Pins are not taken into account.
+    bool see(PackedMove move, int threshold = 0) const;
+    // Cached until the next move, undo or position setup; the legal moves of
+    // recently seen positions are also remembered by hash
+    const GameStatus& evaluateStatus();
     bool isCheckmate();
     bool isStalemate();
     std::vector<Move> getAllPossibleMoves();
+    void generatePossibleMoves(MoveList& possibleMoves);
     void getPawnMoves(const std::shared_ptr<Square> startSquare, std::vector<Move>& possibleMoves);
     void getRookMoves(const std::shared_ptr<Square> startSquare, std::vector<Move>& possibleMoves);
     void getBishopMoves(const std::shared_ptr<Square> startSquare, std::vector<Move>& possibleMoves);
     void getQueenMoves(const std::shared_ptr<Square> startSquare, std::vector<Move>& possibleMoves);
     void getKnightMoves(const std::shared_ptr<Square> startSquare, std::vector<Move>& possibleMoves);
     void getKingMoves(const std::shared_ptr<Square> startSquare, std::vector<Move>& possibleMoves);
+    // Conversions between the packed moves used internally and the rich API moves
+    Move toMove(PackedMove packedMove) const;
+    PackedMove toPackedMove(const Move& move) const;
     void resign();
     bool requestDraw();
     void acceptDraw();
     void declineDraw();
 
     private:
-    void makeMoveTesting(Move move);
-    void undoMoveTesting();
+    void locateKings();
+    uint64_t computeHash() const;
+    EvalScores computeScores() const;
+    void addPieceScore(int code, int square);
+    void removePieceScore(int code, int square);
+    void refreshAccumulators();
+    bool accumulatorInSync() const;
+    uint64_t enPassantKey() const;
+    LegalMoveCache::Key moveCacheKey() const;
+    bool isSquareAttacked(int square, Color byColor, Bitboard occupied) const;
+    Bitboard attackersTo(int square, Color byColor, Bitboard occupied) const;
+    Bitboard pinnedPieces(Color color, int kingSquare) const;
+    Bitboard targetSquares(MoveGenType type) const;
+    void generateCheckEvasions(Bitboard checkers, MoveGenType type, MoveList& evasions);
+    void generateSafeKingMoves(Bitboard targets, MoveList& moves);
+    void generatePieceMoves(int square, Bitboard allowed, MoveGenType type, MoveList& possibleMoves);
+    void generatePawnMoves(int square, Bitboard allowed, MoveGenType type, MoveList& possibleMoves);
+    void generateRookMoves(int square, Bitboard allowed, MoveList& possibleMoves);
+    void generateBishopMoves(int square, Bitboard allowed, MoveList& possibleMoves);
+    void generateQueenMoves(int square, Bitboard allowed, MoveList& possibleMoves);
+    void generateKnightMoves(int square, Bitboard allowed, MoveList& possibleMoves);
+    void generateKingMoves(int square, MoveList& possibleMoves);
+    void generateCastlingMoves(int square, bool legalOnly, MoveList& possibleMoves);
+    void generateEnPassantMoves(bool legalOnly, MoveList& possibleMoves);
+    void addPawnMoves(int from, int to, bool capture, MoveList& possibleMoves);
+    void addTargetMoves(int from, Bitboard targets, MoveList& possibleMoves);
+    void setMoveFlags(Move& move, PackedMove packedMove, Color color) const;
+    void appendMoves(const MoveList& packedMoves, std::vector<Move>& moves) const;
 };
 
 
 
 
-#endif
\ No newline at end of file
+#endif
@@ -52,4 +52,9 @@ std::string GameResult::getResultMessage() const
         default:
             return "Unknown result";
     }
+}
+
+GameResult::ResultType GameResult::resignationBy(Color loser)
+{
+    return loser == WHITE ? ResultType::WHITE_RESIGNED : ResultType::BLACK_RESIGNED;
 }
\ No newline at end of file
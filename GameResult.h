@@ -1,5 +1,6 @@
 #ifndef GAMERESULT_H
 #define GAMERESULT_H
+#include "Types.h"
 #include <string>
 class GameResult
 {
@@ -19,6 +20,7 @@ class GameResult
     void setResult(ResultType resultType, const std::string& reason);
     bool isGameOver() const;
     std::string getResultMessage() const;
+    static ResultType resignationBy(Color loser);
 
     private:
 
@@ -0,0 +1,70 @@
+#include "LegalMoveCache.h"
+
+using namespace std;
+
+LegalMoveCache::LegalMoveCache()
+{
+    this->clear();
+}
+
+bool LegalMoveCache::Key::operator==(const Key& other) const
+{
+    for(int code = 0; code < 12; code++)
+    {
+        if(this->pieces[code] != other.pieces[code])
+        {
+            return false;
+        }
+    }
+    return this->sideToMove == other.sideToMove && this->castlingRights == other.castlingRights &&
+           this->enPassantSquare == other.enPassantSquare;
+}
+
+bool LegalMoveCache::probe(uint64_t hash, const Key& key, MoveList& moves, bool& inCheck)
+{
+    for(int i = 0; i < this->count; i++)
+    {
+        Entry& entry = this->entries[i];
+        if(entry.hash == hash && entry.key == key)
+        {
+            entry.lastUse = ++this->clock;
+            moves = entry.moves;
+            inCheck = entry.inCheck;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Fills the empty slots first, then evicts the least recently used entry
+void LegalMoveCache::store(uint64_t hash, const Key& key, const MoveList& moves, bool inCheck)
+{
+    int slot = this->count;
+    if(this->count < CAPACITY)
+    {
+        this->count++;
+    }
+    else
+    {
+        slot = 0;
+        for(int i = 1; i < CAPACITY; i++)
+        {
+            if(this->entries[i].lastUse < this->entries[slot].lastUse)
+            {
+                slot = i;
+            }
+        }
+    }
+    Entry& entry = this->entries[slot];
+    entry.hash = hash;
+    entry.key = key;
+    entry.inCheck = inCheck;
+    entry.lastUse = ++this->clock;
+    entry.moves = moves;
+}
+
+void LegalMoveCache::clear()
+{
+    this->count = 0;
+    this->clock = 0;
+}
@@ -0,0 +1,48 @@
+#ifndef LEGALMOVECACHE_H
+#define LEGALMOVECACHE_H
+#include "MoveList.h"
+#include "Bitboard.h"
+#include <cstdint>
+
+// A few recently generated legal move lists keyed by position hash. Once
+// full, a new position replaces the one used least recently, so the lists
+// of positions returned to by undoing moves tend to still be there.
+class LegalMoveCache
+{
+    public:
+    static const int CAPACITY = 16;
+
+    // Everything the legal moves depend on. It is compared on a probe, so a
+    // hash collision cannot hand back the moves of another position.
+    struct Key
+    {
+        Bitboard pieces[12];
+        int sideToMove;
+        int castlingRights;
+        int enPassantSquare;
+
+        bool operator==(const Key& other) const;
+    };
+
+    private:
+    struct Entry
+    {
+        uint64_t hash;
+        Key key;
+        bool inCheck;
+        uint32_t lastUse;
+        MoveList moves;
+    };
+
+    Entry entries[CAPACITY];
+    int count;
+    uint32_t clock;
+
+    public:
+    LegalMoveCache();
+    bool probe(uint64_t hash, const Key& key, MoveList& moves, bool& inCheck);
+    void store(uint64_t hash, const Key& key, const MoveList& moves, bool inCheck);
+    void clear();
+};
+
+#endif
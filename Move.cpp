@@ -29,19 +29,20 @@ Move::Move(shared_ptr<Square> startSquare, shared_ptr<Square> endSquare)
         this->enPassantCapturingSquare = nullptr;
     }
 
-Move::Move(const Move& other) 
+Move::Move(shared_ptr<Square> startSquare, shared_ptr<Square> endSquare,
+           shared_ptr<Piece> pieceMoved, shared_ptr<Piece> pieceCaptured)
     {
-    this->startSquare = other.startSquare;
-    this->endSquare = other.endSquare;
-    this->pieceMoved = other.pieceMoved;
-    this->pieceCaptured = other.pieceCaptured;
-    this->isEnPassantMove = other.isEnPassantMove;
-    this->isPawnPromotionMove = other.isPawnPromotionMove;
-    this->pawnPromotionPiece = other.pawnPromotionPiece;
-    this->isKingSideCastleMove = other.isKingSideCastleMove;
-    this->isQueenSideCastleMove = other.isQueenSideCastleMove;
-    this->hadPieceBeenMoved = other.hadPieceBeenMoved;
-    this->enPassantCapturingSquare = other.enPassantCapturingSquare;
+        this->startSquare = startSquare;
+        this->endSquare = endSquare;
+        this->pieceMoved = pieceMoved;
+        this->pieceCaptured = pieceCaptured;
+        this->isEnPassantMove = false;
+        this->isPawnPromotionMove = false;
+        this->isKingSideCastleMove = false;
+        this->isQueenSideCastleMove = false;
+        this->hadPieceBeenMoved = pieceMoved->hasMoved();
+        this->pawnPromotionPiece = nullptr;
+        this->enPassantCapturingSquare = nullptr;
     }
 
 shared_ptr<Square> Move::getStartSquare() const 
@@ -30,7 +30,9 @@ class Move
     //Constructor
     Move(std::shared_ptr<Square> startSquare, std::shared_ptr<Square> endSquare);
 
-    Move(const Move& other);
+    //Adapter constructor used by the engine, which already knows the pieces involved
+    Move(std::shared_ptr<Square> startSquare, std::shared_ptr<Square> endSquare,
+         std::shared_ptr<Piece> pieceMoved, std::shared_ptr<Piece> pieceCaptured);
 
     // getters 
     std::shared_ptr<Square> getStartSquare() const;
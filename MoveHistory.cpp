@@ -0,0 +1,72 @@
+#include "MoveHistory.h"
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+MoveHistory::MoveHistory()
+{
+    this->clear();
+}
+
+void MoveHistory::clear()
+{
+    for(int ply = 0; ply < MAX_PLY; ply++)
+    {
+        this->killers[ply][0] = PackedMove();
+        this->killers[ply][1] = PackedMove();
+    }
+    memset(this->butterfly, 0, sizeof(this->butterfly));
+    for(int piece = 0; piece < 12; piece++)
+    {
+        for(int square = 0; square < 64; square++)
+        {
+            this->counterMoves[piece][square] = PackedMove();
+        }
+    }
+}
+
+PackedMove MoveHistory::getKiller(int ply, int slot) const
+{
+    return ply < MAX_PLY ? this->killers[ply][slot] : PackedMove();
+}
+
+PackedMove MoveHistory::getCounterMove(int piece, int square) const
+{
+    return piece == NO_PIECE ? PackedMove() : this->counterMoves[piece][square];
+}
+
+int MoveHistory::getScore(Color color, PackedMove move) const
+{
+    return this->butterfly[color][move.getFrom()][move.getTo()];
+}
+
+// Deeper cutoffs count for more; the bonus is capped so that a single deep
+// search does not outweigh everything learned before it
+void MoveHistory::update(Color color, int ply, int depth, PackedMove move, int previousPiece, int previousSquare,
+                         const MoveList& triedQuiets)
+{
+    if(ply < MAX_PLY && this->killers[ply][0] != move)
+    {
+        this->killers[ply][1] = this->killers[ply][0];
+        this->killers[ply][0] = move;
+    }
+    if(previousPiece != NO_PIECE)
+    {
+        this->counterMoves[previousPiece][previousSquare] = move;
+    }
+    int bonus = depth * depth < 400 ? depth * depth : 400;
+    this->addScore(color, move, bonus);
+    for(PackedMove tried : triedQuiets)
+    {
+        this->addScore(color, tried, -bonus);
+    }
+}
+
+// Scores move toward the bonus's sign by a share of the room left, so they
+// saturate at MAX_HISTORY instead of growing without bound
+void MoveHistory::addScore(Color color, PackedMove move, int bonus)
+{
+    int& score = this->butterfly[color][move.getFrom()][move.getTo()];
+    score += bonus - score * abs(bonus) / MAX_HISTORY;
+}
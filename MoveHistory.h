@@ -0,0 +1,38 @@
+#ifndef MOVEHISTORY_H
+#define MOVEHISTORY_H
+#include "Types.h"
+#include "MoveList.h"
+
+// What a search has learned about quiet moves, for ordering them: two
+// killer moves per ply (quiet moves that caused a cutoff at that ply), a
+// butterfly history scored by side, from and to square, and a counter move
+// for each previous move, indexed by the piece it moved and its target.
+class MoveHistory
+{
+    public:
+    static const int MAX_PLY = 64;
+    // History scores stay within plus or minus this bound
+    static const int MAX_HISTORY = 16384;
+
+    private:
+    PackedMove killers[MAX_PLY][2];
+    int butterfly[2][64][64];
+    PackedMove counterMoves[12][64];
+
+    public:
+    MoveHistory();
+    void clear();
+    PackedMove getKiller(int ply, int slot) const;
+    PackedMove getCounterMove(int piece, int square) const;
+    int getScore(Color color, PackedMove move) const;
+    // A quiet move caused a cutoff: it becomes a killer at this ply and the
+    // counter move to the previous one, and gains history while the quiet
+    // moves tried before it lose some. previousPiece is NO_PIECE at the root.
+    void update(Color color, int ply, int depth, PackedMove move, int previousPiece, int previousSquare,
+                const MoveList& triedQuiets);
+
+    private:
+    void addScore(Color color, PackedMove move, int bonus);
+};
+
+#endif
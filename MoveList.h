@@ -0,0 +1,48 @@
+#ifndef MOVELIST_H
+#define MOVELIST_H
+
+#include "PackedMove.h"
+#include <cassert>
+#include <cstddef>
+
+// Fixed-capacity list of packed moves stored inline, so move generation
+// never touches the heap. No legal chess position has more than 218 moves,
+// and pseudo-legal generation stays well below the capacity as well.
+class MoveList
+{
+    public:
+    static const size_t CAPACITY = 256;
+
+    private:
+    PackedMove moves[CAPACITY];
+    size_t count;
+
+    public:
+    MoveList() : count(0) {}
+
+    void push_back(PackedMove move)
+    {
+        assert(count < CAPACITY);
+        moves[count++] = move;
+    }
+    void clear() { count = 0; }
+    // Drops the moves past newSize
+    void resize(size_t newSize)
+    {
+        assert(newSize <= count);
+        count = newSize;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    PackedMove& operator[](size_t index) { return moves[index]; }
+    PackedMove operator[](size_t index) const { return moves[index]; }
+
+    PackedMove* begin() { return moves; }
+    PackedMove* end() { return moves + count; }
+    const PackedMove* begin() const { return moves; }
+    const PackedMove* end() const { return moves + count; }
+};
+
+#endif // MOVELIST_H
@@ -0,0 +1,170 @@
+#include "MovePicker.h"
+#include <algorithm>
+
+using namespace std;
+
+// Victim values for ordering captures, indexed by piece type
+static const int ORDER_VALUES[6] = {1, 3, 3, 5, 9, 0};
+
+MovePicker::MovePicker(ChessEngine& engine, PackedMove hashMove, bool capturesOnly)
+    : engine(engine), hashMove(hashMove), capturesOnly(capturesOnly), history(nullptr), stage(HASH_MOVE), index(0)
+{
+}
+
+MovePicker::MovePicker(ChessEngine& engine, PackedMove hashMove, const MoveHistory& history, int ply,
+                       PackedMove counterMove)
+    : engine(engine), hashMove(hashMove), capturesOnly(false), history(&history), stage(HASH_MOVE), index(0)
+{
+    this->refutations[0] = history.getKiller(ply, 0);
+    this->refutations[1] = history.getKiller(ply, 1);
+    this->refutations[2] = counterMove;
+}
+
+PackedMove MovePicker::next()
+{
+    while(true)
+    {
+        switch(this->stage)
+        {
+            case HASH_MOVE:
+                this->stage = GENERATE_CAPTURES;
+                if(!this->hashMove.isNull() && this->engine.isLegal(this->hashMove))
+                {
+                    return this->hashMove;
+                }
+                this->hashMove = PackedMove();
+                break;
+            case GENERATE_CAPTURES:
+                this->engine.generateLegalMoves(this->moves, ChessEngine::CAPTURES);
+                this->scoreCaptures();
+                this->index = 0;
+                this->stage = CAPTURES;
+                break;
+            case CAPTURES:
+            {
+                PackedMove move = this->pickBest();
+                if(!move.isNull())
+                {
+                    return move;
+                }
+                this->stage = this->capturesOnly ? DONE : (this->history ? REFUTATIONS : GENERATE_QUIETS);
+                this->index = 0;
+                break;
+            }
+            case REFUTATIONS:
+                // Quiet moves that refuted a sibling or the previous move
+                // elsewhere; each is checked for legality here
+                while(this->index < 3)
+                {
+                    PackedMove move = this->refutations[this->index];
+                    bool quiet = !move.isNull() && !move.isCapture() && !move.isPromotion();
+                    bool repeated = move == this->hashMove ||
+                                    find(this->refutations, this->refutations + this->index, move) != this->refutations + this->index;
+                    this->index++;
+                    if(quiet && !repeated && this->engine.isLegal(move))
+                    {
+                        return move;
+                    }
+                }
+                this->stage = GENERATE_QUIETS;
+                break;
+            case GENERATE_QUIETS:
+                this->moves.clear();
+                this->engine.generateLegalMoves(this->moves, ChessEngine::QUIETS);
+                this->index = 0;
+                this->stage = QUIETS;
+                if(this->history)
+                {
+                    this->sortQuiets();
+                }
+                break;
+            case QUIETS:
+                while(this->index < this->moves.size())
+                {
+                    PackedMove move = this->moves[this->index++];
+                    if(move != this->hashMove)
+                    {
+                        return move;
+                    }
+                }
+                this->stage = DONE;
+                break;
+            case DONE:
+                return PackedMove();
+        }
+    }
+}
+
+// Most valuable victim first, then least valuable attacker; promotions
+// count the value the pawn gains
+void MovePicker::scoreCaptures()
+{
+    shared_ptr<Board> board = this->engine.getBoard();
+    for(size_t i = 0; i < this->moves.size(); i++)
+    {
+        PackedMove move = this->moves[i];
+        int victim = move.isEnPassant() ? PAWN : pieceCodeType(board->getPieceCode(move.getTo()));
+        int attacker = pieceCodeType(board->getPieceCode(move.getFrom()));
+        int score = 0;
+        if(move.isCapture())
+        {
+            score = ORDER_VALUES[victim] * 8 - ORDER_VALUES[attacker];
+        }
+        if(move.isPromotion())
+        {
+            score += (ORDER_VALUES[move.getPromotionType()] - ORDER_VALUES[PAWN]) * 8;
+        }
+        this->scores[i] = score;
+    }
+}
+
+// Unlike the captures, most quiet moves get searched once the stage is
+// reached, so they are sorted in one insertion sort pass. The refutations
+// were already handed out and are dropped.
+void MovePicker::sortQuiets()
+{
+    Color color = this->engine.getCurrentTurn();
+    size_t count = 0;
+    for(size_t i = 0; i < this->moves.size(); i++)
+    {
+        PackedMove move = this->moves[i];
+        if(move == this->refutations[0] || move == this->refutations[1] || move == this->refutations[2])
+        {
+            continue;
+        }
+        int score = this->history->getScore(color, move);
+        size_t slot = count++;
+        for(; slot > 0 && this->scores[slot - 1] < score; slot--)
+        {
+            this->moves[slot] = this->moves[slot - 1];
+            this->scores[slot] = this->scores[slot - 1];
+        }
+        this->moves[slot] = move;
+        this->scores[slot] = score;
+    }
+    this->moves.resize(count);
+}
+
+// Selection sort one step at a time, so an early cutoff skips the rest of the sort
+PackedMove MovePicker::pickBest()
+{
+    while(this->index < this->moves.size())
+    {
+        size_t best = this->index;
+        for(size_t i = this->index + 1; i < this->moves.size(); i++)
+        {
+            if(this->scores[i] > this->scores[best])
+            {
+                best = i;
+            }
+        }
+        swap(this->moves[best], this->moves[this->index]);
+        swap(this->scores[best], this->scores[this->index]);
+        PackedMove move = this->moves[this->index++];
+        if(move != this->hashMove)
+        {
+            return move;
+        }
+    }
+    return PackedMove();
+}
@@ -0,0 +1,52 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+#include "ChessEngine.h"
+#include "MoveList.h"
+#include "MoveHistory.h"
+
+// Hands out the legal moves of the engine's current position one at a time,
+// generating them in stages: the hash move first, then captures and
+// promotions, most valuable victim first, and the quiet moves last. Given a
+// search's move history, the killer and counter moves lead the quiet moves
+// and the rest follow by history score. A caller that stops early never pays
+// for the stages it did not reach. The position must not change while the
+// picker is in use.
+class MovePicker
+{
+    enum Stage
+    {
+        HASH_MOVE,
+        GENERATE_CAPTURES,
+        CAPTURES,
+        REFUTATIONS,
+        GENERATE_QUIETS,
+        QUIETS,
+        DONE
+    };
+
+    ChessEngine& engine;
+    PackedMove hashMove;
+    bool capturesOnly;
+    const MoveHistory* history;
+    // Killer moves for the ply, then the counter move
+    PackedMove refutations[3];
+    Stage stage;
+    MoveList moves;
+    int scores[MoveList::CAPACITY];
+    size_t index;
+
+    public:
+    // With capturesOnly set the picker stops after the captures and promotions
+    explicit MovePicker(ChessEngine& engine, PackedMove hashMove = PackedMove(), bool capturesOnly = false);
+    // Orders the quiet moves with what the search has learned so far
+    MovePicker(ChessEngine& engine, PackedMove hashMove, const MoveHistory& history, int ply, PackedMove counterMove);
+    // The next move, or a null move once every stage is exhausted
+    PackedMove next();
+
+    private:
+    void scoreCaptures();
+    void sortQuiets();
+    PackedMove pickBest();
+};
+
+#endif
@@ -0,0 +1,248 @@
+#include "Nnue.h"
+#include "Board.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
+
+using namespace std;
+
+// Kernels over one accumulator row: adding or subtracting a weight row,
+// and the clipped activations dotted with the output weights
+typedef void (*UpdateKernel)(int16_t* values, const int16_t* weights);
+typedef int32_t (*OutputKernel)(const int16_t* values, const int8_t* weights);
+
+static void addWeightsScalar(int16_t* values, const int16_t* weights)
+{
+    for(int i = 0; i < NNUE_HIDDEN; i++)
+    {
+        values[i] += weights[i];
+    }
+}
+
+static void subtractWeightsScalar(int16_t* values, const int16_t* weights)
+{
+    for(int i = 0; i < NNUE_HIDDEN; i++)
+    {
+        values[i] -= weights[i];
+    }
+}
+
+static int32_t outputScalar(const int16_t* values, const int8_t* weights)
+{
+    int32_t sum = 0;
+    for(int i = 0; i < NNUE_HIDDEN; i++)
+    {
+        int activation = values[i] < 0 ? 0 : (values[i] > NNUE_QA ? NNUE_QA : values[i]);
+        sum += activation * weights[i];
+    }
+    return sum;
+}
+
+#ifdef HAVE_X86_SIMD
+__attribute__((target("sse4.1")))
+static void addWeightsSse4(int16_t* values, const int16_t* weights)
+{
+    for(int i = 0; i < NNUE_HIDDEN; i += 8)
+    {
+        __m128i* row = reinterpret_cast<__m128i*>(values + i);
+        __m128i weight = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+        _mm_store_si128(row, _mm_add_epi16(_mm_load_si128(row), weight));
+    }
+}
+
+__attribute__((target("sse4.1")))
+static void subtractWeightsSse4(int16_t* values, const int16_t* weights)
+{
+    for(int i = 0; i < NNUE_HIDDEN; i += 8)
+    {
+        __m128i* row = reinterpret_cast<__m128i*>(values + i);
+        __m128i weight = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+        _mm_store_si128(row, _mm_sub_epi16(_mm_load_si128(row), weight));
+    }
+}
+
+// Packing to unsigned bytes clips below at 0, the minimum clips at NNUE_QA;
+// maddubs multiplies by the int8 weights and sums pairs, which cannot
+// saturate since 2 * 127 * 128 fits in an int16
+__attribute__((target("sse4.1")))
+static int32_t outputSse4(const int16_t* values, const int8_t* weights)
+{
+    const __m128i limit = _mm_set1_epi8(NNUE_QA);
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    for(int i = 0; i < NNUE_HIDDEN; i += 16)
+    {
+        __m128i low = _mm_load_si128(reinterpret_cast<const __m128i*>(values + i));
+        __m128i high = _mm_load_si128(reinterpret_cast<const __m128i*>(values + i + 8));
+        __m128i activations = _mm_min_epu8(_mm_packus_epi16(low, high), limit);
+        __m128i weight = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+        __m128i products = _mm_maddubs_epi16(activations, weight);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(products, ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2")))
+static void addWeightsAvx2(int16_t* values, const int16_t* weights)
+{
+    for(int i = 0; i < NNUE_HIDDEN; i += 16)
+    {
+        __m256i* row = reinterpret_cast<__m256i*>(values + i);
+        __m256i weight = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        _mm256_store_si256(row, _mm256_add_epi16(_mm256_load_si256(row), weight));
+    }
+}
+
+__attribute__((target("avx2")))
+static void subtractWeightsAvx2(int16_t* values, const int16_t* weights)
+{
+    for(int i = 0; i < NNUE_HIDDEN; i += 16)
+    {
+        __m256i* row = reinterpret_cast<__m256i*>(values + i);
+        __m256i weight = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        _mm256_store_si256(row, _mm256_sub_epi16(_mm256_load_si256(row), weight));
+    }
+}
+
+// As outputSse4; the 256-bit pack works per 128-bit lane, so the permute
+// puts the bytes back in order before they meet the weights
+__attribute__((target("avx2")))
+static int32_t outputAvx2(const int16_t* values, const int8_t* weights)
+{
+    const __m256i limit = _mm256_set1_epi8(NNUE_QA);
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for(int i = 0; i < NNUE_HIDDEN; i += 32)
+    {
+        __m256i low = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i));
+        __m256i high = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i + 16));
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+        __m256i activations = _mm256_min_epu8(packed, limit);
+        __m256i weight = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        __m256i products = _mm256_maddubs_epi16(activations, weight);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+    }
+    __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    total = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0x4E));
+    total = _mm_add_epi32(total, _mm_shuffle_epi32(total, 0xB1));
+    return _mm_cvtsi128_si32(total);
+}
+#endif
+
+struct NnueKernels
+{
+    const char* name;
+    UpdateKernel addWeights;
+    UpdateKernel subtractWeights;
+    OutputKernel output;
+};
+
+static NnueKernels kernels = {"scalar", addWeightsScalar, subtractWeightsScalar, outputScalar};
+
+// Picks the widest kernels the CPU supports before main runs
+static struct NnueKernelsInit
+{
+    NnueKernelsInit()
+    {
+#ifdef HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2"))
+        {
+            kernels = {"avx2", addWeightsAvx2, subtractWeightsAvx2, outputAvx2};
+        }
+        else if(__builtin_cpu_supports("sse4.1"))
+        {
+            kernels = {"sse4.1", addWeightsSse4, subtractWeightsSse4, outputSse4};
+        }
+#endif
+    }
+} nnueKernelsInit;
+
+const char* nnueKernelName()
+{
+    return kernels.name;
+}
+
+// Input index of a piece as seen from one side: black sees the board with
+// the ranks flipped and the colors swapped, so both halves share weights
+static inline int featureIndex(Color perspective, int code, int square)
+{
+    if(perspective == WHITE)
+    {
+        return code * 64 + square;
+    }
+    return ((code + 6) % 12) * 64 + (square ^ 56);
+}
+
+NnueNetwork::NnueNetwork()
+{
+    memset(this->featureWeights, 0, sizeof(this->featureWeights));
+    memset(this->featureBiases, 0, sizeof(this->featureBiases));
+    memset(this->outputWeights, 0, sizeof(this->outputWeights));
+    this->outputBias = 0;
+}
+
+// The parameters are read as stored, so this expects a little-endian host
+void NnueNetwork::load(const string& filePath)
+{
+    ifstream file(filePath, ios::binary);
+    if(!file)
+    {
+        throw runtime_error("Could not open network file: " + filePath);
+    }
+    char magic[4];
+    uint32_t hidden = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&hidden), sizeof(hidden));
+    if(!file || memcmp(magic, "MLNN", 4) != 0 || hidden != NNUE_HIDDEN)
+    {
+        throw runtime_error("Not a " + to_string(NNUE_HIDDEN) + "-neuron network file: " + filePath);
+    }
+    file.read(reinterpret_cast<char*>(this->featureWeights), sizeof(this->featureWeights));
+    file.read(reinterpret_cast<char*>(this->featureBiases), sizeof(this->featureBiases));
+    file.read(reinterpret_cast<char*>(this->outputWeights), sizeof(this->outputWeights));
+    file.read(reinterpret_cast<char*>(&this->outputBias), sizeof(this->outputBias));
+    if(!file || file.peek() != EOF)
+    {
+        throw runtime_error("Network file has the wrong size: " + filePath);
+    }
+}
+
+void NnueNetwork::refresh(const Board& board, NnueAccumulator& accumulator) const
+{
+    memcpy(accumulator.values[WHITE], this->featureBiases, sizeof(this->featureBiases));
+    memcpy(accumulator.values[BLACK], this->featureBiases, sizeof(this->featureBiases));
+    Bitboard occupied = board.getOccupancy();
+    while(occupied)
+    {
+        int square = popLowestSquare(occupied);
+        this->addPiece(accumulator, board.getPieceCode(square), square);
+    }
+}
+
+void NnueNetwork::addPiece(NnueAccumulator& accumulator, int code, int square) const
+{
+    kernels.addWeights(accumulator.values[WHITE], this->featureWeights[featureIndex(WHITE, code, square)]);
+    kernels.addWeights(accumulator.values[BLACK], this->featureWeights[featureIndex(BLACK, code, square)]);
+}
+
+void NnueNetwork::removePiece(NnueAccumulator& accumulator, int code, int square) const
+{
+    kernels.subtractWeights(accumulator.values[WHITE], this->featureWeights[featureIndex(WHITE, code, square)]);
+    kernels.subtractWeights(accumulator.values[BLACK], this->featureWeights[featureIndex(BLACK, code, square)]);
+}
+
+int NnueNetwork::evaluate(const NnueAccumulator& accumulator, Color sideToMove) const
+{
+    int32_t output = this->outputBias
+        + kernels.output(accumulator.values[sideToMove], this->outputWeights)
+        + kernels.output(accumulator.values[oppositeColor(sideToMove)], this->outputWeights + NNUE_HIDDEN);
+    return static_cast<int>(static_cast<int64_t>(output) * NNUE_SCALE / (NNUE_QA * NNUE_QB));
+}
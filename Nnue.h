@@ -0,0 +1,58 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "Types.h"
+#include <cstdint>
+#include <string>
+
+class Board;
+
+// An efficiently updatable network: 768 inputs (piece code x square) feed
+// a hidden layer of NNUE_HIDDEN neurons per perspective, whose clipped
+// activations feed a single output. The inputs change by a few pieces per
+// move, so the hidden sums are kept in an accumulator and updated by adding
+// and subtracting weight rows instead of being recomputed.
+const int NNUE_INPUTS = 768;
+const int NNUE_HIDDEN = 256;
+
+// Quantization: hidden activations are clipped to 0..NNUE_QA (int8 range),
+// output weights are scaled by NNUE_QB and the raw output is mapped to
+// centipawns by NNUE_SCALE
+const int NNUE_QA = 127;
+const int NNUE_QB = 64;
+const int NNUE_SCALE = 400;
+
+// Hidden layer sums, one row per perspective (indexed by color)
+struct alignas(64) NnueAccumulator
+{
+    int16_t values[2][NNUE_HIDDEN];
+};
+
+class NnueNetwork
+{
+    alignas(64) int16_t featureWeights[NNUE_INPUTS][NNUE_HIDDEN];
+    alignas(64) int16_t featureBiases[NNUE_HIDDEN];
+    // Side to move's half first, then the opponent's
+    alignas(64) int8_t outputWeights[2 * NNUE_HIDDEN];
+    int32_t outputBias;
+
+    public:
+    NnueNetwork();
+
+    // Reads a network file: the magic "MLNN", the hidden layer size as a
+    // uint32, then the feature weights and biases (int16), the output
+    // weights (int8) and the output bias (int32), all little-endian.
+    // Throws std::runtime_error if the file is missing or malformed.
+    void load(const std::string& filePath);
+
+    void refresh(const Board& board, NnueAccumulator& accumulator) const;
+    void addPiece(NnueAccumulator& accumulator, int code, int square) const;
+    void removePiece(NnueAccumulator& accumulator, int code, int square) const;
+    // Centipawns for the side to move
+    int evaluate(const NnueAccumulator& accumulator, Color sideToMove) const;
+};
+
+// Name of the SIMD kernels picked for this CPU: "avx2", "sse4.1" or "scalar"
+const char* nnueKernelName();
+
+#endif // NNUE_H
@@ -57,7 +57,9 @@ void PGNWriter::writePGN(const std::string& filePath,
                 if (legalMove.getStartSquare()->getRow() == move.getStartSquare()->getRow() &&
                     legalMove.getStartSquare()->getCol() == move.getStartSquare()->getCol() &&
                     legalMove.getEndSquare()->getRow() == move.getEndSquare()->getRow() &&
-                    legalMove.getEndSquare()->getCol() == move.getEndSquare()->getCol()) {
+                    legalMove.getEndSquare()->getCol() == move.getEndSquare()->getCol() &&
+                    (!move.getIsPawnPromotionMove() ||
+                     legalMove.getPawnPromotionPiece()->getPieceType() == move.getPawnPromotionPiece()->getPieceType())) {
                     matchingMove = &legalMove;
                     break;
                 }
@@ -77,7 +79,7 @@ void PGNWriter::writePGN(const std::string& filePath,
                 tempEngine->makeMove(*matchingMove);
                 
                 // Add check or checkmate notation
-                std::string opponentColor = (matchingMove->getPieceMoved()->getColor() == "white") ? "black" : "white";
+                Color opponentColor = oppositeColor(matchingMove->getPieceMoved()->getColor());
                 if (tempEngine->isCheckmate()) {
                     notation += "#";
                 } else if (tempEngine->isInCheck(opponentColor)) {
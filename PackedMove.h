@@ -0,0 +1,81 @@
+#ifndef PACKEDMOVE_H
+#define PACKEDMOVE_H
+
+#include "Types.h"
+#include <cstdint>
+#include <string>
+
+// A move packed into 16 bits: from square (bits 0-5), to square (bits 6-11)
+// and a 4-bit flag (bits 12-15). Bit 2 of the flag marks captures and bit 3
+// promotions, whose piece is encoded in the two low flag bits.
+class PackedMove
+{
+    private:
+    uint16_t data;
+
+    public:
+    enum Flag
+    {
+        QUIET = 0,
+        DOUBLE_PAWN_PUSH = 1,
+        KING_CASTLE = 2,
+        QUEEN_CASTLE = 3,
+        CAPTURE = 4,
+        EN_PASSANT = 5,
+        KNIGHT_PROMOTION = 8,
+        BISHOP_PROMOTION = 9,
+        ROOK_PROMOTION = 10,
+        QUEEN_PROMOTION = 11,
+        KNIGHT_PROMOTION_CAPTURE = 12,
+        BISHOP_PROMOTION_CAPTURE = 13,
+        ROOK_PROMOTION_CAPTURE = 14,
+        QUEEN_PROMOTION_CAPTURE = 15
+    };
+
+    PackedMove() : data(0) {}
+    PackedMove(int from, int to, int flags)
+        : data(static_cast<uint16_t>(from | (to << 6) | (flags << 12))) {}
+
+    // Rebuilds a move from getData(), e.g. as kept in a hash table
+    static PackedMove fromData(uint16_t data)
+    {
+        PackedMove move;
+        move.data = data;
+        return move;
+    }
+
+    int getFrom() const { return data & 0x3F; }
+    int getTo() const { return (data >> 6) & 0x3F; }
+    int getFlags() const { return data >> 12; }
+    uint16_t getData() const { return data; }
+
+    bool isCapture() const { return (data & 0x4000) != 0; }
+    bool isPromotion() const { return (data & 0x8000) != 0; }
+    bool isEnPassant() const { return getFlags() == EN_PASSANT; }
+    bool isCastle() const { return getFlags() == KING_CASTLE || getFlags() == QUEEN_CASTLE; }
+    bool isDoublePawnPush() const { return getFlags() == DOUBLE_PAWN_PUSH; }
+    bool isNull() const { return data == 0; }
+
+    // Only meaningful for promotions: KNIGHT, BISHOP, ROOK or QUEEN
+    PieceType getPromotionType() const { return static_cast<PieceType>(KNIGHT + (getFlags() & 3)); }
+
+    // Coordinate notation, e.g. "e2e4" or "e7e8q"
+    std::string toString() const
+    {
+        std::string text;
+        text += static_cast<char>('a' + squareCol(getFrom()));
+        text += static_cast<char>('8' - squareRow(getFrom()));
+        text += static_cast<char>('a' + squareCol(getTo()));
+        text += static_cast<char>('8' - squareRow(getTo()));
+        if(isPromotion())
+        {
+            text += "nbrq"[getPromotionType() - KNIGHT];
+        }
+        return text;
+    }
+
+    bool operator==(const PackedMove& other) const { return data == other.data; }
+    bool operator!=(const PackedMove& other) const { return data != other.data; }
+};
+
+#endif // PACKEDMOVE_H
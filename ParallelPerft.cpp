@@ -0,0 +1,125 @@
+#include "ParallelPerft.h"
+#include <thread>
+
+using namespace std;
+
+// Keep splitting until there are this many tasks per thread
+static const size_t TASKS_PER_THREAD = 8;
+
+ParallelPerft::ParallelPerft(const ChessEngine& engine, int threadCount, PerftTable* table)
+    : engine(engine), threadCount(threadCount < 1 ? 1 : threadCount), table(table), queues(this->threadCount)
+{
+    MoveList moves;
+    this->engine.generateLegalMoves(moves);
+    this->rootMoves.assign(moves.begin(), moves.end());
+}
+
+const vector<PackedMove>& ParallelPerft::getRootMoves() const
+{
+    return this->rootMoves;
+}
+
+vector<uint64_t> ParallelPerft::run(int depth)
+{
+    vector<uint64_t> totals(this->rootMoves.size(), 0);
+    if(depth < 1)
+    {
+        return totals;
+    }
+
+    vector<Task> tasks = this->splitTasks(depth);
+    for(size_t i = 0; i < tasks.size(); i++)
+    {
+        this->queues[i % this->threadCount].tasks.push_back(tasks[i]);
+    }
+
+    vector<vector<uint64_t>> counts(this->threadCount, vector<uint64_t>(this->rootMoves.size(), 0));
+    vector<thread> workers;
+    for(int worker = 0; worker < this->threadCount; worker++)
+    {
+        workers.emplace_back(&ParallelPerft::work, this, worker, ref(counts[worker]));
+    }
+    for(thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    for(const vector<uint64_t>& workerCounts : counts)
+    {
+        for(size_t i = 0; i < totals.size(); i++)
+        {
+            totals[i] += workerCounts[i];
+        }
+    }
+    return totals;
+}
+
+// One task per root move, expanded a ply at a time while there are too few
+// to balance and the subtrees are still deep enough to be worth a task
+vector<ParallelPerft::Task> ParallelPerft::splitTasks(int depth)
+{
+    vector<Task> tasks;
+    for(size_t i = 0; i < this->rootMoves.size(); i++)
+    {
+        this->engine.makeMove(this->rootMoves[i]);
+        tasks.push_back(Task{this->engine.getPosition(), depth - 1, static_cast<int>(i)});
+        this->engine.undoMove();
+    }
+
+    ChessEngine scratch(this->engine);
+    while(!tasks.empty() && tasks.size() < TASKS_PER_THREAD * this->threadCount && tasks.front().depth > 2)
+    {
+        vector<Task> expanded;
+        for(const Task& task : tasks)
+        {
+            scratch.setPosition(task.position);
+            MoveList children;
+            scratch.generateLegalMoves(children);
+            for(PackedMove child : children)
+            {
+                scratch.makeMove(child);
+                expanded.push_back(Task{scratch.getPosition(), task.depth - 1, task.rootIndex});
+                scratch.undoMove();
+            }
+        }
+        tasks.swap(expanded);
+    }
+    return tasks;
+}
+
+// Own queue from the back, otherwise steal from the front of another
+bool ParallelPerft::nextTask(int worker, Task& task)
+{
+    for(int i = 0; i < this->threadCount; i++)
+    {
+        WorkQueue& queue = this->queues[(worker + i) % this->threadCount];
+        lock_guard<mutex> guard(queue.lock);
+        if(queue.tasks.empty())
+        {
+            continue;
+        }
+        if(i == 0)
+        {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+
+void ParallelPerft::work(int worker, vector<uint64_t>& counts)
+{
+    ChessEngine local(this->engine);
+    Task task;
+    while(this->nextTask(worker, task))
+    {
+        local.setPosition(task.position);
+        counts[task.rootIndex] += this->table ? local.perft(task.depth, *this->table) : local.perft(task.depth);
+    }
+}
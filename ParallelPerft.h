@@ -0,0 +1,50 @@
+#ifndef PARALLELPERFT_H
+#define PARALLELPERFT_H
+#include "ChessEngine.h"
+#include "PerftTable.h"
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// Perft on several threads. The tree is cut into subtree tasks (below the
+// root moves, or deeper when there are too few of them to keep every thread
+// busy) which are dealt out to per-thread queues; a thread that runs dry
+// steals from the front of the others' queues. A task carries a copy of its
+// position, so a thread loads it into its own engine instead of replaying
+// moves, and keeps its own counters, summed once all finish.
+class ParallelPerft
+{
+    struct Task
+    {
+        Position position;
+        int depth;
+        int rootIndex;
+    };
+
+    struct WorkQueue
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    ChessEngine engine;
+    int threadCount;
+    PerftTable* table;
+    std::vector<PackedMove> rootMoves;
+    std::vector<WorkQueue> queues;
+
+    public:
+    // With a table, all threads share it to reuse each other's subtree counts
+    ParallelPerft(const ChessEngine& engine, int threadCount, PerftTable* table = nullptr);
+    // Node count below each root move, in the order of getRootMoves()
+    std::vector<uint64_t> run(int depth);
+    const std::vector<PackedMove>& getRootMoves() const;
+
+    private:
+    std::vector<Task> splitTasks(int depth);
+    bool nextTask(int worker, Task& task);
+    void work(int worker, std::vector<uint64_t>& counts);
+};
+
+#endif
@@ -0,0 +1,52 @@
+#include "PerftTable.h"
+
+using namespace std;
+
+// Rounds the budget down to a power of two entries, at least one
+PerftTable::PerftTable(size_t megabytes)
+{
+    size_t count = 1;
+    while(count * 2 * sizeof(Entry) <= megabytes * 1024 * 1024)
+    {
+        count *= 2;
+    }
+    this->entries.reset(new Entry[count]);
+    this->mask = count - 1;
+    this->clear();
+}
+
+bool PerftTable::probe(uint64_t hash, int depth, uint64_t& nodes) const
+{
+    const Entry& entry = this->entries[hash & this->mask];
+    uint64_t data = entry.data.load(memory_order_relaxed);
+    uint64_t check = entry.check.load(memory_order_relaxed);
+    if((check ^ data) != hash || static_cast<int>(data & 0xFF) != depth)
+    {
+        return false;
+    }
+    nodes = data >> 8;
+    return true;
+}
+
+// Always replaces: recent subtrees are the likeliest to transpose again
+void PerftTable::store(uint64_t hash, int depth, uint64_t nodes)
+{
+    Entry& entry = this->entries[hash & this->mask];
+    uint64_t data = (nodes << 8) | static_cast<uint64_t>(depth & 0xFF);
+    entry.data.store(data, memory_order_relaxed);
+    entry.check.store(hash ^ data, memory_order_relaxed);
+}
+
+void PerftTable::clear()
+{
+    for(uint64_t i = 0; i <= this->mask; i++)
+    {
+        this->entries[i].data.store(0, memory_order_relaxed);
+        this->entries[i].check.store(0, memory_order_relaxed);
+    }
+}
+
+size_t PerftTable::getSize() const
+{
+    return this->mask + 1;
+}
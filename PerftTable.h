@@ -0,0 +1,31 @@
+#ifndef PERFTTABLE_H
+#define PERFTTABLE_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Fixed-size table of perft subtree counts keyed by position hash and depth.
+// It is shared between threads without locks: each slot stores the key
+// XORed with its data, so a slot torn by two concurrent writers no longer
+// verifies and reads as a miss instead of a wrong count.
+class PerftTable
+{
+    struct Entry
+    {
+        std::atomic<uint64_t> check;  // hash ^ data
+        std::atomic<uint64_t> data;   // node count << 8 | depth
+    };
+
+    std::unique_ptr<Entry[]> entries;
+    uint64_t mask;
+
+    public:
+    explicit PerftTable(size_t megabytes);
+    bool probe(uint64_t hash, int depth, uint64_t& nodes) const;
+    void store(uint64_t hash, int depth, uint64_t nodes);
+    void clear();
+    size_t getSize() const;
+};
+
+#endif
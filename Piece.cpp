@@ -1,19 +1,17 @@
 #include "Piece.h"
-#include <stdexcept>
-#include <algorithm>
 
 // Constructor
-Piece::Piece(const std::string& color) : color(color), moved(false) {
-    if (color != "white" && color != "black") {
-        throw std::invalid_argument("Invalid color: " + color + ". Must be 'white' or 'black'.");
-    }
-}
+Piece::Piece(Color color, PieceType type) : color(color), type(type), moved(false) {}
 
 // Getters
-std::string Piece::getColor() const {
+Color Piece::getColor() const {
     return color;
 }
 
+PieceType Piece::getPieceType() const {
+    return type;
+}
+
 bool Piece::hasMoved() const {
     return moved;
 }
@@ -22,45 +20,37 @@ void Piece::setMoved(bool moved) {
     this->moved = moved;
 }
 
+std::string Piece::getColorName() const {
+    return colorName(color);
+}
+
 // Get the type of piece (class name)
 std::string Piece::getType() const {
-    // This will be overridden by derived classes if needed
-    // For now, we'll extract it from typeid
-    std::string typeName = typeid(*this).name();
-    
-    // Remove numbers and decorations from typeid output
-    std::string result;
-    for (char c : typeName) {
-        if (std::isalpha(c)) {
-            result += c;
-        }
+    switch (type) {
+        case PAWN:   return "Pawn";
+        case KNIGHT: return "Knight";
+        case BISHOP: return "Bishop";
+        case ROOK:   return "Rook";
+        case QUEEN:  return "Queen";
+        default:     return "King";
     }
-    
-    // If the result is empty or mangled, return a generic name
-    if (result.empty()) {
-        return "Piece";
-    }
-    
-    return result;
 }
 
 // Get the letter representation of the piece (used in algebraic notation)
 std::string Piece::getPieceLetter() const {
-    std::string type = getType();
-    
-    if (type.find("King") != std::string::npos) return "K";
-    if (type.find("Queen") != std::string::npos) return "Q";
-    if (type.find("Rook") != std::string::npos) return "R";
-    if (type.find("Bishop") != std::string::npos) return "B";
-    if (type.find("Knight") != std::string::npos) return "N";
-    if (type.find("Pawn") != std::string::npos) return "";  // Pawns don't have a letter
-    
-    return "";
+    switch (type) {
+        case KING:   return "K";
+        case QUEEN:  return "Q";
+        case ROOK:   return "R";
+        case BISHOP: return "B";
+        case KNIGHT: return "N";
+        default:     return "";  // Pawns don't have a letter
+    }
 }
 
 // Get abbreviated piece string (e.g., "wQ" for white queen)
 std::string Piece::getPieceStr() const {
-    std::string colorPrefix = (color == "white") ? "w" : "b";
+    std::string colorPrefix = (color == WHITE) ? "w" : "b";
     std::string letter = getPieceLetter();
     
     if (letter.empty()) {
@@ -1,30 +1,34 @@
 #ifndef PIECE_H
 #define PIECE_H
 
+#include "Types.h"
 #include <string>
-#include <vector>
 
 class Piece {
 protected:
-    std::string color;
+    Color color;
+    PieceType type;
     bool moved;
 
 public:
     // Constructor
-    Piece(const std::string& color);
+    Piece(Color color, PieceType type);
 
     // Virtual destructor for proper cleanup of derived classes
     virtual ~Piece() = default;
 
-    // Pure virtual methods (must be implemented by derived classes)
-    virtual std::vector<std::vector<int>> getPossibleMoves(int row, int col) const = 0;
+    // Pure virtual method (must be implemented by derived classes)
     virtual std::string getSymbol() const = 0;
 
     // Concrete methods
-    std::string getColor() const;
+    Color getColor() const;
+    PieceType getPieceType() const;
     bool hasMoved() const;
     void setMoved(bool moved);
-    virtual std::string getType() const;
+
+    // String forms, for display only
+    std::string getColorName() const;
+    std::string getType() const;
     std::string getPieceLetter() const;
     std::string getPieceStr() const;
     std::string toString() const;
@@ -0,0 +1,31 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include "Bitboard.h"
+#include "Evaluation.h"
+#include <cstdint>
+#include <type_traits>
+
+// Everything that identifies a game position, in one flat value that can be
+// copied with memcpy: the piece bitboards and mailbox, side to move,
+// castling rights, en passant square, move clocks, king squares, the
+// Zobrist hash and the evaluation sums. The move history is not part of it;
+// the occupancy is rebuilt from the piece bitboards.
+struct Position
+{
+    Bitboard pieces[12];
+    uint64_t hash;
+    uint8_t board[64];          // piece code per square, NO_PIECE if empty
+    uint8_t sideToMove;         // Color
+    uint8_t castlingRights;
+    uint8_t enPassantSquare;    // NO_SQUARE if none
+    uint8_t halfmoveClock;      // saturates at 255
+    uint16_t fullmoveNumber;
+    uint8_t kingSquares[2];
+    EvalScores scores;
+};
+
+static_assert(std::is_trivially_copyable<Position>::value, "Position must stay trivially copyable");
+static_assert(sizeof(Position) < 200, "Position must stay under 200 bytes");
+
+#endif // POSITION_H
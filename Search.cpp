@@ -0,0 +1,360 @@
+#include "Search.h"
+#include "MovePicker.h"
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+// Helper threads skip alternating runs of depths, each run skipSize[i] long
+// and shifted by skipPhase[i], so the threads spread over several depths
+static const int SKIP_PATTERNS = 20;
+static const int SKIP_SIZE[SKIP_PATTERNS] = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+static const int SKIP_PHASE[SKIP_PATTERNS] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+// Mate scores are stored relative to the node rather than the root, so
+// they stay right when the position is reached at another ply
+static int scoreToTable(int score, int ply)
+{
+    if(Search::isMateScore(score))
+    {
+        return score > 0 ? score + ply : score - ply;
+    }
+    return score;
+}
+
+static int scoreFromTable(int score, int ply)
+{
+    if(Search::isMateScore(score))
+    {
+        return score > 0 ? score - ply : score + ply;
+    }
+    return score;
+}
+
+Search::Search(ChessEngine& engine, TranspositionTable* table)
+    : engine(engine), table(table), threadIndex(0), threadData(nullptr), stopFlag(nullptr),
+      nodes(0), stopped(false), followPv(false)
+{
+}
+
+void Search::setThread(int index, SearchThreadData* data, const atomic<bool>* stopFlag)
+{
+    this->threadIndex = index;
+    this->threadData = data;
+    this->stopFlag = stopFlag;
+}
+
+void Search::setIterationCallback(const function<void(const SearchResult&)>& callback)
+{
+    this->onIteration = callback;
+}
+
+SearchResult Search::run(const SearchLimits& limits)
+{
+    this->limits = limits;
+    this->nodes = 0;
+    this->stopped = false;
+    this->previousPv.clear();
+    this->history.clear();
+
+    SearchResult result;
+    MoveList rootMoves;
+    this->engine.generateLegalMoves(rootMoves);
+    if(rootMoves.empty())
+    {
+        return result;
+    }
+    result.bestMove = rootMoves[0];
+
+    int maxDepth = limits.depth > 0 ? min(limits.depth, MAX_PLY - 1) : MAX_PLY - 1;
+    for(int depth = 1; depth <= maxDepth; depth++)
+    {
+        if(this->skipsDepth(depth))
+        {
+            continue;
+        }
+        this->followPv = true;
+        int score = this->negamax(depth, 0, -INFINITE_SCORE, INFINITE_SCORE);
+        // An unfinished iteration may not have looked at the best move yet
+        if(this->stopped)
+        {
+            break;
+        }
+        result.depth = depth;
+        result.score = score;
+        result.pv.assign(this->pvTable[0], this->pvTable[0] + this->pvLength[0]);
+        if(!result.pv.empty())
+        {
+            result.bestMove = result.pv[0];
+        }
+        this->previousPv = result.pv;
+        result.nodes = this->nodes;
+        if(this->threadData)
+        {
+            this->threadData->depth.store(depth, memory_order_relaxed);
+        }
+        if(this->onIteration)
+        {
+            this->onIteration(result);
+        }
+
+        // A mate this close is final; deeper iterations cannot improve on it
+        if(isMateScore(score) && MATE_SCORE - abs(score) <= depth)
+        {
+            break;
+        }
+    }
+    result.nodes = this->nodes;
+    return result;
+}
+
+PackedMove Search::bestMove(const SearchLimits& limits)
+{
+    return this->run(limits).bestMove;
+}
+
+bool Search::isMateScore(int score)
+{
+    return abs(score) >= MATE_SCORE - MAX_PLY;
+}
+
+int Search::negamax(int depth, int ply, int alpha, int beta)
+{
+    this->pvLength[ply] = ply;
+    if(depth <= 0)
+    {
+        return this->quiescence(ply, alpha, beta);
+    }
+    if(this->shouldStop())
+    {
+        return 0;
+    }
+    this->nodes++;
+    if(ply > 0 && (this->engine.getHalfmoveClock() >= 100 || this->engine.isRepetition()))
+    {
+        return 0;
+    }
+    if(ply >= MAX_PLY - 1)
+    {
+        return this->evaluate();
+    }
+
+    // A stored result searched at least this deep may settle the node outright
+    PackedMove tableMove;
+    if(this->table)
+    {
+        int tableScore;
+        int tableDepth;
+        TranspositionTable::Bound bound;
+        if(this->table->probe(this->engine.getHash(), tableMove, tableScore, tableDepth, bound) &&
+           ply > 0 && tableDepth >= depth)
+        {
+            tableScore = scoreFromTable(tableScore, ply);
+            if(bound == TranspositionTable::EXACT ||
+               (bound == TranspositionTable::LOWER_BOUND && tableScore >= beta) ||
+               (bound == TranspositionTable::UPPER_BOUND && tableScore <= alpha))
+            {
+                return tableScore;
+            }
+        }
+    }
+
+    bool inCheck = this->engine.isInCheck(this->engine.getCurrentTurn());
+    if(inCheck)
+    {
+        depth++;
+    }
+
+    // Along the previous principal variation its move is tried first,
+    // elsewhere the move stored for the position
+    PackedMove pvMove;
+    if(this->followPv)
+    {
+        if(ply < static_cast<int>(this->previousPv.size()))
+        {
+            pvMove = this->previousPv[ply];
+        }
+        else
+        {
+            this->followPv = false;
+        }
+    }
+
+    // The counter move answers the move that led here
+    int previousPiece = this->engine.getLastMovedPiece();
+    int previousSquare = this->engine.getLastMoveTarget();
+    Color color = this->engine.getCurrentTurn();
+    MovePicker picker(this->engine, pvMove.isNull() ? tableMove : pvMove, this->history, ply,
+                      this->history.getCounterMove(previousPiece, previousSquare));
+    int originalAlpha = alpha;
+    int bestScore = -INFINITE_SCORE;
+    PackedMove bestMove;
+    int legalMoves = 0;
+    MoveList triedQuiets;
+    for(PackedMove move = picker.next(); !move.isNull(); move = picker.next())
+    {
+        legalMoves++;
+        bool quiet = !move.isCapture() && !move.isPromotion();
+        this->followPv = this->followPv && move == pvMove;
+        this->engine.makeMoveUnchecked(move);
+        int score = -this->negamax(depth - 1, ply + 1, -beta, -alpha);
+        this->engine.undoMoveUnchecked();
+        this->followPv = false;
+        if(this->stopped)
+        {
+            return 0;
+        }
+        if(score > bestScore)
+        {
+            bestScore = score;
+            bestMove = move;
+            if(score > alpha)
+            {
+                alpha = score;
+                this->updatePv(ply, move);
+                if(alpha >= beta)
+                {
+                    if(quiet)
+                    {
+                        this->history.update(color, ply, depth, move, previousPiece, previousSquare, triedQuiets);
+                    }
+                    break;
+                }
+            }
+        }
+        if(quiet)
+        {
+            triedQuiets.push_back(move);
+        }
+    }
+
+    if(legalMoves == 0)
+    {
+        return inCheck ? -MATE_SCORE + ply : 0;
+    }
+    if(this->table)
+    {
+        TranspositionTable::Bound bound = TranspositionTable::EXACT;
+        if(bestScore >= beta)
+        {
+            bound = TranspositionTable::LOWER_BOUND;
+        }
+        else if(bestScore <= originalAlpha)
+        {
+            bound = TranspositionTable::UPPER_BOUND;
+        }
+        this->table->store(this->engine.getHash(), bestMove, scoreToTable(bestScore, ply), depth, bound);
+    }
+    return bestScore;
+}
+
+// Only captures and promotions are searched, unless the side to move is in
+// check and has to consider every evasion. Otherwise it may stand pat on
+// the static evaluation instead of capturing, and skips captures that lose
+// material in the exchange.
+int Search::quiescence(int ply, int alpha, int beta)
+{
+    this->pvLength[ply] = ply;
+    if(this->shouldStop())
+    {
+        return 0;
+    }
+    this->nodes++;
+    if(ply >= MAX_PLY - 1)
+    {
+        return this->evaluate();
+    }
+
+    bool inCheck = this->engine.isInCheck(this->engine.getCurrentTurn());
+    int bestScore = -INFINITE_SCORE;
+    if(!inCheck)
+    {
+        bestScore = this->evaluate();
+        if(bestScore >= beta)
+        {
+            return bestScore;
+        }
+        alpha = max(alpha, bestScore);
+    }
+
+    MovePicker picker(this->engine, PackedMove(), !inCheck);
+    int legalMoves = 0;
+    for(PackedMove move = picker.next(); !move.isNull(); move = picker.next())
+    {
+        legalMoves++;
+        // A capture that loses material cannot beat standing pat
+        if(!inCheck && !this->engine.see(move, 0))
+        {
+            continue;
+        }
+        this->engine.makeMoveUnchecked(move);
+        int score = -this->quiescence(ply + 1, -beta, -alpha);
+        this->engine.undoMoveUnchecked();
+        if(this->stopped)
+        {
+            return 0;
+        }
+        if(score > bestScore)
+        {
+            bestScore = score;
+            if(score > alpha)
+            {
+                alpha = score;
+                if(alpha >= beta)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    if(inCheck && legalMoves == 0)
+    {
+        return -MATE_SCORE + ply;
+    }
+    return bestScore;
+}
+
+int Search::evaluate() const
+{
+    return this->engine.evaluate();
+}
+
+// The main thread (index zero) searches every depth
+bool Search::skipsDepth(int depth) const
+{
+    if(this->threadIndex == 0)
+    {
+        return false;
+    }
+    int pattern = (this->threadIndex - 1) % SKIP_PATTERNS;
+    return ((depth + SKIP_PHASE[pattern]) / SKIP_SIZE[pattern]) % 2 != 0;
+}
+
+bool Search::shouldStop()
+{
+    if(this->limits.nodes > 0 && this->nodes >= this->limits.nodes)
+    {
+        this->stopped = true;
+    }
+    if(this->stopFlag && this->stopFlag->load(memory_order_relaxed))
+    {
+        this->stopped = true;
+    }
+    if(this->threadData)
+    {
+        this->threadData->nodes.store(this->nodes, memory_order_relaxed);
+    }
+    return this->stopped;
+}
+
+// Triangular PV table: a node's line is its move followed by the child's line
+void Search::updatePv(int ply, PackedMove move)
+{
+    this->pvTable[ply][ply] = move;
+    for(int i = ply + 1; i < this->pvLength[ply + 1]; i++)
+    {
+        this->pvTable[ply][i] = this->pvTable[ply + 1][i];
+    }
+    this->pvLength[ply] = this->pvLength[ply + 1];
+}
@@ -0,0 +1,88 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+#include "ChessEngine.h"
+#include "TranspositionTable.h"
+#include "MoveHistory.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Limits on a search; zero means no limit
+struct SearchLimits
+{
+    int depth = 0;
+    uint64_t nodes = 0;
+};
+
+// Outcome of the last iteration the search completed
+struct SearchResult
+{
+    PackedMove bestMove;
+    int score = 0;  // centipawns for the side to move
+    int depth = 0;
+    uint64_t nodes = 0;
+    std::vector<PackedMove> pv;
+};
+
+// Progress of one search thread, read by the others while it runs. Each
+// thread's counters sit on a cache line of their own so that updating them
+// does not keep invalidating a neighbour's.
+struct alignas(64) SearchThreadData
+{
+    std::atomic<uint64_t> nodes{0};
+    std::atomic<int> depth{0};
+};
+
+// Negamax alpha-beta with iterative deepening over the engine's legal move
+// generation. Each iteration searches the principal variation of the last
+// one first; a quiescence search over captures settles the leaves. Moves
+// are made and undone on the engine itself, which is left as it was found.
+// With a transposition table, results found in other branches, or by other
+// threads sharing the table, cut the search short and order its moves.
+// Quiet moves that cause cutoffs are remembered to order later nodes.
+class Search
+{
+    public:
+    static const int MAX_PLY = 64;
+    static const int INFINITE_SCORE = 32000;
+    static const int MATE_SCORE = 31000;
+
+    private:
+    ChessEngine& engine;
+    TranspositionTable* table;
+    int threadIndex;
+    SearchThreadData* threadData;
+    const std::atomic<bool>* stopFlag;
+    std::function<void(const SearchResult&)> onIteration;
+    SearchLimits limits;
+    uint64_t nodes;
+    bool stopped;
+    bool followPv;
+    std::vector<PackedMove> previousPv;
+    PackedMove pvTable[MAX_PLY][MAX_PLY];
+    int pvLength[MAX_PLY];
+    MoveHistory history;
+
+    public:
+    explicit Search(ChessEngine& engine, TranspositionTable* table = nullptr);
+    // Runs as one of several Lazy SMP threads: helpers (index above zero)
+    // skip some depths, progress is published and a raised flag stops it
+    void setThread(int index, SearchThreadData* data, const std::atomic<bool>* stopFlag);
+    // Called after every completed iteration
+    void setIterationCallback(const std::function<void(const SearchResult&)>& callback);
+    SearchResult run(const SearchLimits& limits);
+    PackedMove bestMove(const SearchLimits& limits);
+    // Mate scores count the plies to mate down from MATE_SCORE
+    static bool isMateScore(int score);
+
+    private:
+    int negamax(int depth, int ply, int alpha, int beta);
+    int quiescence(int ply, int alpha, int beta);
+    int evaluate() const;
+    bool skipsDepth(int depth) const;
+    bool shouldStop();
+    void updatePv(int ply, PackedMove move);
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include "SmpSearch.h"
+#include <thread>
+
+using namespace std;
+
+SmpSearch::SmpSearch(const ChessEngine& engine, int threadCount, TranspositionTable& table)
+    : engine(engine), threadCount(threadCount < 1 ? 1 : threadCount), table(table),
+      threadData(this->threadCount), stop(false)
+{
+}
+
+void SmpSearch::setIterationCallback(const function<void(const SearchResult&)>& callback)
+{
+    this->onIteration = callback;
+}
+
+SearchResult SmpSearch::run(const SearchLimits& limits)
+{
+    this->stop.store(false);
+    this->table.newSearch();
+    for(SearchThreadData& data : this->threadData)
+    {
+        data.nodes.store(0);
+        data.depth.store(0);
+    }
+
+    vector<thread> helpers;
+    for(int index = 1; index < this->threadCount; index++)
+    {
+        helpers.emplace_back(&SmpSearch::help, this, index);
+    }
+
+    ChessEngine local(this->engine);
+    Search search(local, &this->table);
+    search.setThread(0, &this->threadData[0], &this->stop);
+    if(this->onIteration)
+    {
+        // Report the nodes of every thread, not just the main one
+        search.setIterationCallback([this](const SearchResult& iteration)
+        {
+            SearchResult report = iteration;
+            report.nodes = this->getNodes();
+            this->onIteration(report);
+        });
+    }
+    SearchResult result = search.run(limits);
+
+    this->stop.store(true);
+    for(thread& helper : helpers)
+    {
+        helper.join();
+    }
+    result.nodes = this->getNodes();
+    return result;
+}
+
+// Helpers search without limits of their own until the main thread is done
+void SmpSearch::help(int index)
+{
+    ChessEngine local(this->engine);
+    Search search(local, &this->table);
+    search.setThread(index, &this->threadData[index], &this->stop);
+    search.run(SearchLimits());
+}
+
+uint64_t SmpSearch::getNodes() const
+{
+    uint64_t nodes = 0;
+    for(const SearchThreadData& data : this->threadData)
+    {
+        nodes += data.nodes.load(memory_order_relaxed);
+    }
+    return nodes;
+}
+
+int SmpSearch::getThreadCount() const
+{
+    return this->threadCount;
+}
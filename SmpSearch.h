@@ -0,0 +1,38 @@
+#ifndef SMPSEARCH_H
+#define SMPSEARCH_H
+#include "ChessEngine.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <functional>
+#include <vector>
+
+// Lazy SMP: every thread searches the same root on its own copy of the
+// engine, and they cooperate only through the shared transposition table.
+// Helper threads skip depths in staggered patterns so they run ahead of the
+// main thread and fill the table with results it is about to need. The
+// main thread's limits decide when everyone stops, and its result is the
+// one returned; a node limit counts the main thread's nodes only.
+class SmpSearch
+{
+    ChessEngine engine;
+    int threadCount;
+    TranspositionTable& table;
+    std::vector<SearchThreadData> threadData;
+    std::atomic<bool> stop;
+    std::function<void(const SearchResult&)> onIteration;
+
+    public:
+    SmpSearch(const ChessEngine& engine, int threadCount, TranspositionTable& table);
+    // Called from the main thread after each of its iterations
+    void setIterationCallback(const std::function<void(const SearchResult&)>& callback);
+    SearchResult run(const SearchLimits& limits);
+    // Nodes searched so far by all threads together
+    uint64_t getNodes() const;
+    int getThreadCount() const;
+
+    private:
+    void help(int index);
+};
+
+#endif
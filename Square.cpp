@@ -59,10 +59,9 @@ bool Square::isLightSquare() const {
 std::string Square::toString() const {
     if (piece) {
         std::string symbol = piece->getSymbol();
-        std::string color = piece->getColor();
         
         // ANSI color codes
-        std::string colorCode = (color == "white") ? "\033[97m" : "\033[30m";
+        std::string colorCode = (piece->getColor() == WHITE) ? "\033[97m" : "\033[30m";
         std::string bgColor = isLightSquare() ? "\033[48;5;222m" : "\033[48;5;94m";
         std::string reset = "\033[0m";
         
@@ -78,7 +77,7 @@ std::string Square::toStringDetailed() const {
     std::ostringstream oss;
     oss << "Square " << getAlgebraicNotation();
     if (piece) {
-        oss << " contains " << piece->getColor() << " " << piece->getType();
+        oss << " contains " << piece->getColorName() << " " << piece->getType();
     } else {
         oss << " is empty";
     }
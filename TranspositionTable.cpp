@@ -0,0 +1,169 @@
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+static const int GENERATION_BITS = 6;
+static const int GENERATION_MASK = (1 << GENERATION_BITS) - 1;
+
+static int entryDepth(uint64_t data)
+{
+    return static_cast<int>((data >> 32) & 0xFF);
+}
+
+static int entryGeneration(uint64_t data)
+{
+    return static_cast<int>((data >> 42) & GENERATION_MASK);
+}
+
+void TranspositionTable::FreeMemory::operator()(Bucket* buckets) const
+{
+    free(buckets);
+}
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+    : buckets(nullptr), mask(0), generation(0)
+{
+    this->resize(megabytes);
+}
+
+// Rounds the budget down to a power of two buckets, at least one. Tables of
+// a huge page or more start on a huge page boundary, and on Linux the
+// kernel is asked to back them with huge pages to spare TLB misses.
+void TranspositionTable::resize(size_t megabytes)
+{
+    size_t count = 1;
+    while(count * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024)
+    {
+        count *= 2;
+    }
+    size_t bytes = count * sizeof(Bucket);
+    size_t alignment = bytes >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : alignof(Bucket);
+
+    this->buckets.reset();
+    void* memory = aligned_alloc(alignment, bytes);
+    if(!memory)
+    {
+        throw bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    if(alignment == HUGE_PAGE_SIZE)
+    {
+        madvise(memory, bytes, MADV_HUGEPAGE);
+    }
+#endif
+    Bucket* table = static_cast<Bucket*>(memory);
+    for(size_t i = 0; i < count; i++)
+    {
+        new (&table[i]) Bucket;
+    }
+    this->buckets.reset(table);
+    this->mask = count - 1;
+    this->clear();
+}
+
+void TranspositionTable::newSearch()
+{
+    this->generation = (this->generation + 1) & GENERATION_MASK;
+}
+
+bool TranspositionTable::probe(uint64_t hash, PackedMove& move, int& score, int& depth, Bound& bound) const
+{
+    const Bucket& bucket = this->buckets[hash & this->mask];
+    for(const Entry& entry : bucket.entries)
+    {
+        uint64_t data = entry.data.load(memory_order_relaxed);
+        uint64_t check = entry.check.load(memory_order_relaxed);
+        if((check ^ data) != hash || data == 0)
+        {
+            continue;
+        }
+        move = PackedMove::fromData(static_cast<uint16_t>(data));
+        score = static_cast<int16_t>(data >> 16);
+        depth = entryDepth(data);
+        bound = static_cast<Bound>((data >> 40) & 3);
+        return true;
+    }
+    return false;
+}
+
+// The position's own entry is updated in place, keeping its move when the
+// new result has none; otherwise the entry worth least is replaced, with
+// each search of age costing as much as eight plies of depth
+void TranspositionTable::store(uint64_t hash, PackedMove move, int score, int depth, Bound bound)
+{
+    Bucket& bucket = this->buckets[hash & this->mask];
+    Entry* victim = &bucket.entries[0];
+    int victimWorth = 0;
+    for(int i = 0; i < BUCKET_SIZE; i++)
+    {
+        Entry& entry = bucket.entries[i];
+        uint64_t data = entry.data.load(memory_order_relaxed);
+        if(data != 0 && (entry.check.load(memory_order_relaxed) ^ data) == hash)
+        {
+            if(move.isNull())
+            {
+                move = PackedMove::fromData(static_cast<uint16_t>(data));
+            }
+            victim = &entry;
+            break;
+        }
+        int age = (this->generation - entryGeneration(data)) & GENERATION_MASK;
+        int worth = data == 0 ? -1000 : entryDepth(data) - 8 * age;
+        if(i == 0 || worth < victimWorth)
+        {
+            victim = &entry;
+            victimWorth = worth;
+        }
+    }
+
+    uint64_t data = static_cast<uint64_t>(move.getData()) |
+                    static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16 |
+                    static_cast<uint64_t>(depth & 0xFF) << 32 |
+                    static_cast<uint64_t>(bound) << 40 |
+                    static_cast<uint64_t>(this->generation) << 42;
+    victim->data.store(data, memory_order_relaxed);
+    victim->check.store(hash ^ data, memory_order_relaxed);
+}
+
+void TranspositionTable::clear()
+{
+    for(uint64_t i = 0; i <= this->mask; i++)
+    {
+        for(Entry& entry : this->buckets[i].entries)
+        {
+            entry.data.store(0, memory_order_relaxed);
+            entry.check.store(0, memory_order_relaxed);
+        }
+    }
+}
+
+size_t TranspositionTable::getSize() const
+{
+    return (this->mask + 1) * BUCKET_SIZE;
+}
+
+// Samples the first thousand entries, or the whole table if smaller
+int TranspositionTable::hashfull() const
+{
+    size_t sampleBuckets = min<size_t>(1000 / BUCKET_SIZE, this->mask + 1);
+    int used = 0;
+    for(size_t i = 0; i < sampleBuckets; i++)
+    {
+        for(const Entry& entry : this->buckets[i].entries)
+        {
+            uint64_t data = entry.data.load(memory_order_relaxed);
+            if(data != 0 && entryGeneration(data) == this->generation)
+            {
+                used++;
+            }
+        }
+    }
+    return static_cast<int>(used * 1000 / (sampleBuckets * BUCKET_SIZE));
+}
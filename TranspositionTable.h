@@ -0,0 +1,67 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+#include "PackedMove.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Search results keyed by position hash, shared by all search threads
+// without locks. Like the perft table, each slot stores the key XORed with
+// its data, so a slot torn by concurrent writers reads as a miss.
+//
+// Slots are grouped in buckets of one cache line, so a probe touches a
+// single line. A new result replaces the bucket's emptiest, shallowest or
+// oldest entry; age counts the searches since the entry was written, using
+// a generation counter bumped by newSearch(). The table is allocated
+// aligned to huge pages when it is big enough to fill one.
+class TranspositionTable
+{
+    public:
+    // How the stored score relates to the true one
+    enum Bound
+    {
+        UPPER_BOUND = 1,
+        LOWER_BOUND = 2,
+        EXACT = 3
+    };
+
+    private:
+    struct Entry
+    {
+        std::atomic<uint64_t> check;  // hash ^ data
+        std::atomic<uint64_t> data;   // move | score << 16 | depth << 32 | bound << 40 | generation << 42
+    };
+
+    static const int BUCKET_SIZE = 4;
+
+    struct alignas(64) Bucket
+    {
+        Entry entries[BUCKET_SIZE];
+    };
+
+    struct FreeMemory
+    {
+        void operator()(Bucket* buckets) const;
+    };
+
+    std::unique_ptr<Bucket[], FreeMemory> buckets;
+    uint64_t mask;
+    uint8_t generation;
+
+    public:
+    explicit TranspositionTable(size_t megabytes);
+    // Drops every entry and reallocates to the new budget
+    void resize(size_t megabytes);
+    // Marks the entries written so far as one search older
+    void newSearch();
+    bool probe(uint64_t hash, PackedMove& move, int& score, int& depth, Bound& bound) const;
+    void store(uint64_t hash, PackedMove move, int score, int depth, Bound bound);
+    void clear();
+    // Entries in the table
+    size_t getSize() const;
+    // Permille of a sample of entries written in the current search
+    int hashfull() const;
+};
+
+#endif
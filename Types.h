@@ -0,0 +1,82 @@
+#ifndef TYPES_H
+#define TYPES_H
+
+#include <string>
+
+// Side colors, used as array indices by the position core
+enum Color
+{
+    WHITE,
+    BLACK
+};
+
+// Piece kinds, used as array indices by the position core
+enum PieceType
+{
+    PAWN,
+    KNIGHT,
+    BISHOP,
+    ROOK,
+    QUEEN,
+    KING
+};
+
+// A piece code packs color and type into 0..11 (white pawn .. black king)
+const int NO_PIECE = 12;
+
+constexpr int makePieceCode(Color color, PieceType type)
+{
+    return color * 6 + type;
+}
+
+constexpr Color pieceCodeColor(int code)
+{
+    return code < 6 ? WHITE : BLACK;
+}
+
+constexpr PieceType pieceCodeType(int code)
+{
+    return static_cast<PieceType>(code % 6);
+}
+
+constexpr Color oppositeColor(Color color)
+{
+    return color == WHITE ? BLACK : WHITE;
+}
+
+// Display form of a color ("white" or "black")
+inline std::string colorName(Color color)
+{
+    return color == WHITE ? "white" : "black";
+}
+
+// Castling rights, combined as a bit set
+enum CastlingRight
+{
+    WHITE_KINGSIDE = 1,
+    WHITE_QUEENSIDE = 2,
+    BLACK_KINGSIDE = 4,
+    BLACK_QUEENSIDE = 8,
+    ALL_CASTLING = 15
+};
+
+// Squares are indexed row * 8 + col, so a8 is 0 and h1 is 63,
+// matching the row/col layout used by Board and Square
+const int NO_SQUARE = 64;
+
+constexpr int makeSquareIndex(int row, int col)
+{
+    return row * 8 + col;
+}
+
+constexpr int squareRow(int square)
+{
+    return square >> 3;
+}
+
+constexpr int squareCol(int square)
+{
+    return square & 7;
+}
+
+#endif // TYPES_H
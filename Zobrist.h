@@ -0,0 +1,52 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "Types.h"
+#include <cstdint>
+
+// Random keys XORed together to identify a position: one per piece code and
+// square, one for black to move, one per castling rights set and one per
+// en passant file. Generated at compile time from a fixed seed, so hashes
+// are stable between runs.
+struct ZobristKeys
+{
+    uint64_t pieces[12][64];
+    uint64_t side;
+    uint64_t castling[16];
+    uint64_t enPassantFile[8];
+};
+
+constexpr uint64_t splitMix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys makeZobristKeys()
+{
+    ZobristKeys keys = {};
+    uint64_t state = 0x5EED5EED5EED5EEDULL;
+    for(int code = 0; code < 12; code++)
+    {
+        for(int square = 0; square < 64; square++)
+        {
+            keys.pieces[code][square] = splitMix64(state);
+        }
+    }
+    keys.side = splitMix64(state);
+    for(int rights = 0; rights < 16; rights++)
+    {
+        keys.castling[rights] = splitMix64(state);
+    }
+    for(int file = 0; file < 8; file++)
+    {
+        keys.enPassantFile[file] = splitMix64(state);
+    }
+    return keys;
+}
+
+inline constexpr ZobristKeys zobristKeys = makeZobristKeys();
+
+#endif // ZOBRIST_H
@@ -0,0 +1,109 @@
+#include "ChessEngine.h"
+#include "Nnue.h"
+#include "SmpSearch.h"
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Searches a position to a fixed depth and reports every iteration, for
+// measuring search speed and how it scales with the number of threads.
+//
+//   bench [--threads N] [--hash MB] [--nodes N] [--nnue FILE] <depth> [FEN]
+
+void printUsage() {
+    std::cout << "Usage: bench [--threads N] [--hash MB] [--nodes N] [--nnue FILE] <depth> [FEN]" << std::endl;
+    std::cout << "  --threads N  Lazy SMP search threads (0 = all cores, default 1)" << std::endl;
+    std::cout << "  --hash MB    transposition table size in megabytes (default 16)" << std::endl;
+    std::cout << "  --nodes N    stop the main thread after N nodes" << std::endl;
+    std::cout << "  --nnue FILE  evaluate with the network in FILE" << std::endl;
+    std::cout << "  FEN          position to search (default: starting position)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int threads = 1;
+    int hashMegabytes = 16;
+    SearchLimits limits;
+    limits.depth = -1;
+    std::string fen;
+    std::string networkFile;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+            if (threads <= 0) {
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+        } else if (arg == "--hash" && i + 1 < argc) {
+            hashMegabytes = std::atoi(argv[++i]);
+        } else if (arg == "--nodes" && i + 1 < argc) {
+            limits.nodes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--nnue" && i + 1 < argc) {
+            networkFile = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else if (limits.depth < 0) {
+            limits.depth = std::atoi(arg.c_str());
+        } else {
+            // The FEN may be passed quoted or as separate words
+            fen += (fen.empty() ? "" : " ") + arg;
+        }
+    }
+    if (limits.depth < 1) {
+        printUsage();
+        return 1;
+    }
+
+    ChessEngine engine;
+    try {
+        if (!fen.empty()) {
+            engine.loadFEN(fen);
+        }
+        if (!networkFile.empty()) {
+            auto network = std::make_shared<NnueNetwork>();
+            network->load(networkFile);
+            engine.setNetwork(network);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    TranspositionTable table(hashMegabytes);
+    SmpSearch search(engine, threads, table);
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&start]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // One line per depth: the time column is the time to reach that depth
+    search.setIterationCallback([&elapsed](const SearchResult& iteration) {
+        double seconds = elapsed();
+        std::cout << "depth " << iteration.depth << " score " << iteration.score
+                  << " nodes " << iteration.nodes << " time " << seconds
+                  << " nps " << static_cast<uint64_t>(seconds > 0 ? iteration.nodes / seconds : 0) << " pv";
+        for (PackedMove move : iteration.pv) {
+            std::cout << " " << move.toString();
+        }
+        std::cout << std::endl;
+    });
+    SearchResult result = search.run(limits);
+    double seconds = elapsed();
+
+    std::cout << std::endl;
+    std::cout << "Best:    " << result.bestMove.toString() << std::endl;
+    std::cout << "Depth:   " << result.depth << std::endl;
+    std::cout << "Threads: " << threads << std::endl;
+    std::cout << "Eval:    " << (networkFile.empty() ? std::string("tables") : std::string("nnue (") + nnueKernelName() + ")") << std::endl;
+    std::cout << "Hash:    " << hashMegabytes << " MB, " << table.hashfull() / 10.0 << "% full" << std::endl;
+    std::cout << "Nodes:   " << result.nodes << std::endl;
+    std::cout << "Time:    " << seconds << " s" << std::endl;
+    std::cout << "NPS:     " << static_cast<uint64_t>(seconds > 0 ? result.nodes / seconds : 0) << std::endl;
+    return 0;
+}
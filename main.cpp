@@ -2,12 +2,17 @@
 #include "PGNReader.h"
 #include "PGNWriter.h"
 #include "AlgebraicNotationParser.h"
+#include "SmpSearch.h"
+#include "TranspositionTable.h"
 #include "exceptions/ChessException.h"
 #include <iostream>
 #include <memory>
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <cstdlib>
+#include <optional>
+#include <thread>
 
 // Helper function to validate square notation
 bool isValidSquare(const std::string& square) {
@@ -25,6 +30,21 @@ std::string trim(const std::string& str) {
     return str.substr(first, (last - first + 1));
 }
 
+// Reads a whole number of at least minimum; empty or invalid input keeps the default
+int promptNumber(const std::string& prompt, int defaultValue, int minimum) {
+    std::cout << prompt;
+    std::string text;
+    std::getline(std::cin, text);
+    try {
+        if (!trim(text).empty()) {
+            return std::max(minimum, std::stoi(text));
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Invalid number, using " << defaultValue << "." << std::endl;
+    }
+    return defaultValue;
+}
+
 void displayWelcome() {
     std::cout << "\n╔════════════════════════════════════════╗" << std::endl;
     std::cout << "║     Welcome to Mo-Lights Chess C++    ║" << std::endl;
@@ -35,7 +55,8 @@ void displayMainMenu() {
     std::cout << "\n========== Main Menu ==========" << std::endl;
     std::cout << "1. Start New Game" << std::endl;
     std::cout << "2. Load Game from PGN" << std::endl;
-    std::cout << "3. Quit" << std::endl;
+    std::cout << "3. Play vs Engine" << std::endl;
+    std::cout << "4. Quit" << std::endl;
     std::cout << "===============================" << std::endl;
     std::cout << "Choose an option: ";
 }
@@ -54,9 +75,44 @@ void displayGameCommands() {
     std::cout << "---------------------\n" << std::endl;
 }
 
-void playGame(std::shared_ptr<ChessEngine> engine) {
+// Score in pawns, or the moves to mate, from the side to move's view
+std::string formatScore(int score) {
+    std::ostringstream text;
+    if (Search::isMateScore(score)) {
+        int plies = Search::MATE_SCORE - std::abs(score);
+        text << (score > 0 ? "mate in " : "mated in ") << (plies + 1) / 2;
+    } else {
+        text << std::showpos << score / 100.0;
+    }
+    return text.str();
+}
+
+// Searches the current position on the given threads and plays the best move found
+void playEngineMove(std::shared_ptr<ChessEngine> engine, AlgebraicNotationParser& parser,
+                    const SearchLimits& limits, int threads, TranspositionTable& table) {
+    std::cout << "\nEngine is thinking..." << std::endl;
+    SmpSearch search(*engine, threads, table);
+    SearchResult result = search.run(limits);
+    if (result.bestMove.isNull()) {
+        return;
+    }
+    std::string san = parser.toAlgebraicNotation(engine->toMove(result.bestMove));
+    std::cout << "Engine plays " << san << " (depth " << result.depth << ", score "
+              << formatScore(result.score) << ", " << result.nodes << " nodes, pv";
+    for (PackedMove move : result.pv) {
+        std::cout << " " << move.toString();
+    }
+    std::cout << ")" << std::endl;
+    engine->makeMove(result.bestMove);
+}
+
+// With an engine side, that side's moves come from the search
+void playGame(std::shared_ptr<ChessEngine> engine, bool vsEngine = false, Color engineColor = BLACK,
+              const SearchLimits& limits = SearchLimits(), int threads = 1, int hashMegabytes = 16) {
     AlgebraicNotationParser parser(engine);
     bool inGame = true;
+    // Kept for the whole game, so each search starts from what the last one learned
+    TranspositionTable table(vsEngine ? hashMegabytes : 0);
     
     std::cout << "\nGame started!" << std::endl;
     displayGameCommands();
@@ -70,10 +126,10 @@ void playGame(std::shared_ptr<ChessEngine> engine) {
         }
         
         // Display current state
-        std::cout << "\nCurrent turn: " << engine->getCurrentTurn() << std::endl;
+        std::cout << "\nCurrent turn: " << engine->getCurrentTurnName() << std::endl;
         
         // Show draw offer if pending
-        if (!engine->getDrawRequestedBy().empty() && engine->getDrawRequestedBy() != engine->getCurrentTurn()) {
+        if (!engine->getDrawRequestedBy().empty() && engine->getDrawRequestedBy() != engine->getCurrentTurnName()) {
             std::cout << "⚡ " << engine->getDrawRequestedBy() << " has requested a draw. Type 'draw' to accept or 'decline' to refuse." << std::endl;
         }
         
@@ -83,26 +139,32 @@ void playGame(std::shared_ptr<ChessEngine> engine) {
             std::cout << "Error printing board: " << e.what() << std::endl;
         }
         
-        // Check for checkmate and stalemate
-        if (engine->isCheckmate()) {
-            std::string winner = (engine->getCurrentTurn() == "white") ? "Black" : "White";
+        // Check for checkmate and stalemate; the status is worked out once per position
+        const GameStatus& status = engine->evaluateStatus();
+        if (status.checkmate) {
+            std::string winner = (engine->getCurrentTurn() == WHITE) ? "Black" : "White";
             std::cout << "\n🏆 Checkmate! " << winner << " wins! 🏆" << std::endl;
             inGame = false;
             continue;
         }
         
-        if (engine->isStalemate()) {
+        if (status.stalemate) {
             std::cout << "\n🤝 Stalemate! The game is a draw. 🤝" << std::endl;
             inGame = false;
             continue;
         }
         
-        if (engine->isInCheck(engine->getCurrentTurn())) {
+        if (status.inCheck) {
             std::cout << "⚠️  Check! ⚠️" << std::endl;
         }
         
+        if (vsEngine && engine->getCurrentTurn() == engineColor) {
+            playEngineMove(engine, parser, limits, threads, table);
+            continue;
+        }
+        
         // Get player input
-        std::cout << "\n" << engine->getCurrentTurn() << " > ";
+        std::cout << "\n" << engine->getCurrentTurnName() << " > ";
         std::string input;
         std::getline(std::cin, input);
         input = trim(input);
@@ -127,6 +189,10 @@ void playGame(std::shared_ptr<ChessEngine> engine) {
                     std::cout << "No moves to undo!" << std::endl;
                 } else {
                     engine->undoMove();
+                    // Take back the engine's reply together with the player's move
+                    if (vsEngine && engine->getCurrentTurn() == engineColor && !engine->getMoveLog().empty()) {
+                        engine->undoMove();
+                    }
                     std::cout << "Move undone." << std::endl;
                 }
             }
@@ -148,7 +214,7 @@ void playGame(std::shared_ptr<ChessEngine> engine) {
                 confirm = trim(confirm);
                 if (confirm == "y" || confirm == "Y") {
                     engine->resign();
-                    std::cout << engine->getCurrentTurn() << " has resigned." << std::endl;
+                    std::cout << engine->getCurrentTurnName() << " has resigned." << std::endl;
                     inGame = false;
                 }
             }
@@ -157,7 +223,7 @@ void playGame(std::shared_ptr<ChessEngine> engine) {
                     std::cout << "Draw agreed! The game is a draw." << std::endl;
                     inGame = false;
                 } else {
-                    if (engine->getDrawRequestedBy() == engine->getCurrentTurn()) {
+                    if (engine->getDrawRequestedBy() == engine->getCurrentTurnName()) {
                         std::cout << "You have already requested a draw. Wait for opponent's response." << std::endl;
                     } else {
                         std::cout << "Draw offer sent to opponent." << std::endl;
@@ -188,29 +254,13 @@ void playGame(std::shared_ptr<ChessEngine> engine) {
                 std::string firstToken, secondToken;
                 iss >> firstToken >> secondToken;
                 
-                Move* moveToMakePtr = nullptr;
-                bool foundMove = false;
+                std::optional<Move> moveToMake;
                 
                 // Try algebraic notation first if only one token
                 if (secondToken.empty()) {
                     try {
-                        Move parsedMove = parser.parseMove(firstToken);
-                        // Now find this move in legal moves to get the proper reference
-                        auto legalMoves = engine->getAllLegalMoves();
-                        for (auto& move : legalMoves) {
-                            if (move.getStartSquare()->getRow() == parsedMove.getStartSquare()->getRow() &&
-                                move.getStartSquare()->getCol() == parsedMove.getStartSquare()->getCol() &&
-                                move.getEndSquare()->getRow() == parsedMove.getEndSquare()->getRow() &&
-                                move.getEndSquare()->getCol() == parsedMove.getEndSquare()->getCol()) {
-                                moveToMakePtr = &move;
-                                foundMove = true;
-                                break;
-                            }
-                        }
-                        if (!foundMove) {
-                            std::cout << "Invalid move notation: " << firstToken << std::endl;
-                            continue;
-                        }
+                        // The parser only returns legal moves
+                        moveToMake = parser.parseMove(firstToken);
                     } catch (const std::exception& e) {
                         std::cout << "Invalid move notation: " << firstToken << std::endl;
                         continue;
@@ -230,30 +280,26 @@ void playGame(std::shared_ptr<ChessEngine> engine) {
                         continue;
                     }
                     
-                    // Find matching legal move
-                    auto legalMoves = engine->getAllLegalMoves();
-                    for (auto& legalMove : legalMoves) {
-                        if (legalMove.getStartSquare()->getAlgebraicNotation() == firstToken &&
-                            legalMove.getEndSquare()->getAlgebraicNotation() == secondToken) {
-                            moveToMakePtr = &legalMove;
-                            foundMove = true;
+                    // Find the matching legal move in the position's cached list
+                    for (PackedMove legalMove : engine->evaluateStatus().legalMoves) {
+                        if (legalMove.toString().substr(0, 4) == firstToken + secondToken) {
+                            moveToMake = engine->toMove(legalMove);
                             break;
                         }
                     }
                     
-                    if (!foundMove) {
+                    if (!moveToMake) {
                         std::cout << "Illegal move: " << firstToken << " to " << secondToken << std::endl;
                         continue;
                     }
                 }
                 
-                if (foundMove && moveToMakePtr != nullptr) {
-                    // Make a copy of the move to execute
-                    Move moveToExecute = *moveToMakePtr;
+                if (moveToMake) {
+                    Move moveToExecute = *moveToMake;
                     
                     // Handle pawn promotion
                     if (moveToExecute.getIsPawnPromotionMove()) {
-                        std::string color = moveToExecute.getPieceMoved()->getColor();
+                        Color color = moveToExecute.getPieceMoved()->getColor();
                         std::string promoChoice;
                         
                         // Check if promotion piece is specified in the input (algebraic notation)
@@ -305,9 +351,10 @@ void playGame(std::shared_ptr<ChessEngine> engine) {
             try {
                 PGNWriter writer(engine);
                 std::string result = "*";
-                if (engine->isCheckmate()) {
-                    result = (engine->getCurrentTurn() == "white") ? "0-1" : "1-0";
-                } else if (engine->isStalemate()) {
+                const GameStatus& status = engine->evaluateStatus();
+                if (status.checkmate) {
+                    result = (engine->getCurrentTurn() == WHITE) ? "0-1" : "1-0";
+                } else if (status.stalemate) {
                     result = "1/2-1/2";
                 }
                 writer.writePGN(filename, "Game", "Local", "White", "Black", result);
@@ -356,11 +403,30 @@ int main() {
             }
         }
         else if (choice == "3") {
+            // Play against the search
+            std::cout << "Play as (w/b): ";
+            std::string side;
+            std::getline(std::cin, side);
+            side = trim(side);
+            Color engineColor = (side == "b" || side == "B") ? WHITE : BLACK;
+            
+            SearchLimits limits;
+            limits.depth = promptNumber("Engine search depth (default 5): ", 5, 1);
+            int threads = promptNumber("Engine threads (default 0 = all cores): ", 0, 0);
+            if (threads == 0) {
+                threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            }
+            int hashMegabytes = promptNumber("Engine hash table size in MB (default 16): ", 16, 1);
+            
+            auto engine = std::make_shared<ChessEngine>();
+            playGame(engine, true, engineColor, limits, threads, hashMegabytes);
+        }
+        else if (choice == "4") {
             std::cout << "\nThanks for playing Mo-Lights Chess! Goodbye! 👋" << std::endl;
             running = false;
         }
         else {
-            std::cout << "Invalid option. Please choose 1, 2, or 3." << std::endl;
+            std::cout << "Invalid option. Please choose 1, 2, 3, or 4." << std::endl;
         }
     }
     
@@ -0,0 +1,111 @@
+#include "ChessEngine.h"
+#include "ParallelPerft.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Counts legal move tree leaves from the start position or a FEN, for
+// checking move generation against known totals and measuring its speed.
+//
+//   perft [--divide] [--threads N] [--hash MB] <depth> [FEN]
+
+void printUsage() {
+    std::cout << "Usage: perft [--divide] [--threads N] [--hash MB] <depth> [FEN]" << std::endl;
+    std::cout << "  --divide     print the node count below each root move" << std::endl;
+    std::cout << "  --threads N  split the tree over N threads (0 = all cores, default 1)" << std::endl;
+    std::cout << "  --hash MB    reuse transposed subtree counts from a table of MB megabytes" << std::endl;
+    std::cout << "  FEN          position to search (default: starting position)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    bool divide = false;
+    int threads = 1;
+    int hashMegabytes = 0;
+    int depth = -1;
+    std::string fen;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--divide") {
+            divide = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+            if (threads <= 0) {
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+        } else if (arg == "--hash" && i + 1 < argc) {
+            hashMegabytes = std::atoi(argv[++i]);
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        } else if (depth < 0) {
+            depth = std::atoi(arg.c_str());
+        } else {
+            // The FEN may be passed quoted or as separate words
+            fen += (fen.empty() ? "" : " ") + arg;
+        }
+    }
+    if (depth < 1) {
+        printUsage();
+        return 1;
+    }
+
+    ChessEngine engine;
+    if (!fen.empty()) {
+        try {
+            engine.loadFEN(fen);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = 0;
+    if (threads > 1 || hashMegabytes > 0) {
+        std::unique_ptr<PerftTable> table;
+        if (hashMegabytes > 0) {
+            table.reset(new PerftTable(hashMegabytes));
+        }
+        ParallelPerft parallel(engine, threads, table.get());
+        std::vector<uint64_t> counts = parallel.run(depth);
+        for (size_t i = 0; i < counts.size(); i++) {
+            if (divide) {
+                std::cout << parallel.getRootMoves()[i].toString() << ": " << counts[i] << std::endl;
+            }
+            nodes += counts[i];
+        }
+        if (divide) {
+            std::cout << std::endl;
+        }
+    } else if (divide) {
+        MoveList rootMoves;
+        engine.generateLegalMoves(rootMoves);
+        for (PackedMove move : rootMoves) {
+            engine.makeMove(move);
+            uint64_t count = engine.perft(depth - 1);
+            engine.undoMove();
+            std::cout << move.toString() << ": " << count << std::endl;
+            nodes += count;
+        }
+        std::cout << std::endl;
+    } else {
+        nodes = engine.perft(depth);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Depth: " << depth << std::endl;
+    std::cout << "Threads: " << threads << std::endl;
+    if (hashMegabytes > 0) {
+        std::cout << "Hash:  " << hashMegabytes << " MB" << std::endl;
+    }
+    std::cout << "Nodes: " << nodes << std::endl;
+    std::cout << "Time:  " << seconds << " s" << std::endl;
+    std::cout << "NPS:   " << static_cast<uint64_t>(seconds > 0 ? nodes / seconds : 0) << std::endl;
+    return 0;
+}
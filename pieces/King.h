@@ -6,12 +6,10 @@
 class King : public Piece {
 public:
     // Constructor
-    King(const std::string& color);
+    King(Color color);
 
     // Override abstract methods
-    std::vector<std::vector<int>> getPossibleMoves(int row, int col) const override;
     std::string getSymbol() const override;
-    std::string getType() const override;
 };
 
 #endif // KING_H
@@ -6,12 +6,10 @@
 class Knight : public Piece {
 public:
     // Constructor
-    Knight(const std::string& color);
+    Knight(Color color);
 
     // Override abstract methods
-    std::vector<std::vector<int>> getPossibleMoves(int row, int col) const override;
     std::string getSymbol() const override;
-    std::string getType() const override;
 };
 
 #endif // KNIGHT_H
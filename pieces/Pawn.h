@@ -6,12 +6,10 @@
 class Pawn : public Piece {
 public:
     // Constructor
-    Pawn(const std::string& color);
+    Pawn(Color color);
 
     // Override abstract methods
-    std::vector<std::vector<int>> getPossibleMoves(int row, int col) const override;
     std::string getSymbol() const override;
-    std::string getType() const override;
 };
 
 #endif // PAWN_H
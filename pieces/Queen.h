@@ -6,12 +6,10 @@
 class Queen : public Piece {
 public:
     // Constructor
-    Queen(const std::string& color);
+    Queen(Color color);
 
     // Override abstract methods
-    std::vector<std::vector<int>> getPossibleMoves(int row, int col) const override;
     std::string getSymbol() const override;
-    std::string getType() const override;
 };
 
 #endif // QUEEN_H
@@ -6,12 +6,10 @@
 class Rook : public Piece {
 public:
     // Constructor
-    Rook(const std::string& color);
+    Rook(Color color);
 
     // Override abstract methods
-    std::vector<std::vector<int>> getPossibleMoves(int row, int col) const override;
     std::string getSymbol() const override;
-    std::string getType() const override;
 };
 
 #endif // ROOK_H